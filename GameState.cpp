@@ -1,4 +1,5 @@
 #include "GameState.h"
+#include "profiler.h"
 
 void FieldState::Pause()
 {
@@ -32,6 +33,10 @@ int FieldState::HandleEvents(SDL_Event &event, bool &quit)
 			//press c to toggle collision boxes
 			getManager()->getWorld()->toggleColBox();
 			break;
+		case SDLK_F1:
+			//press F1 to toggle the performance overlay
+			getManager()->getWorld()->toggleOverlay();
+			break;
 		case SDLK_0:
 			//press 0 to set to fullscreen
 			SDL_SetWindowFullscreen(getManager()->getWorld()->getWin()->getWindow(), SDL_WINDOW_FULLSCREEN);
@@ -40,6 +45,10 @@ int FieldState::HandleEvents(SDL_Event &event, bool &quit)
 			//press space to change to pause state
 			nextState = MENU_STATE;
 			break;
+		case SDLK_F9:
+			//press F9 to export the frame profile, in builds with the profiler
+			PROFILE_EXPORT("profile.json");
+			break;
 		default:
 			break;
 		}
@@ -56,11 +65,14 @@ int FieldState::HandleEvents(SDL_Event &event, bool &quit)
 void FieldState::Update()
 {
 	//Logic
-	if (getManager()->getWorld()->shouldLoadNextLevel())
-		getManager()->getWorld()->openMap(getManager()->getWorld()->getNextLevel());
+	//The next level loads in the background, and the current level keeps running until it is ready.
 	//When the mLoadNextLevel trigger is activated, the caller should also change the mNextLevel and mNextPlayerSpawn variables.
+	getManager()->getWorld()->updateLevelLoad();
 
 	getManager()->getWorld()->moveActors();
+
+	//walking near an exit preloads its map, and walking into it activates the trigger
+	getManager()->getWorld()->checkExits();
 }
 
 void FieldState::Draw()
@@ -69,11 +81,23 @@ void FieldState::Draw()
 
 	//Render
 	World->parallaxBg();
-	World->drawBackground(World->getLevel()->getTileMap());
-	World->drawBackground(World->getLevel()->getTileMap2());
+	{
+		PROFILE_ZONE("drawBackground background");
+		World->drawBackground(World->getLevel()->getTileMap());
+	}
+	{
+		PROFILE_ZONE("drawBackground background2");
+		World->drawBackground(World->getLevel()->getTileMap2());
+	}
 	World->drawActors();
-	World->drawBackground(World->getLevel()->getOverMap());
-	World->drawBackground(World->getLevel()->getOverMap2());
+	{
+		PROFILE_ZONE("drawBackground overlayer");
+		World->drawBackground(World->getLevel()->getOverMap());
+	}
+	{
+		PROFILE_ZONE("drawBackground overlayer2");
+		World->drawBackground(World->getLevel()->getOverMap2());
+	}
 }
 
 int PauseState::HandleEvents(SDL_Event &event, bool &quit)
@@ -12,9 +12,6 @@ const int ANIM_BOTRIGHT = 7;
 const int MAX_FRAMES = 4;
 const int WALK_ANIMATION_TICKS = 180;
 
-//Actor speed is in pixels per second.
-const int VELOCITY = 65;
-
 Tile::Tile(GameWorld *World, SDL_Texture* sprite, float x, float y, SDL_Rect* srcClip)
 	:mPosx(x), mPosy(y), mWorld(World)
 {
@@ -41,28 +38,33 @@ void Tile::drawAnimate(Window &window)
 {
 	//use window to draw objects
 	//sprites will be drawn relative to the camera view
-	window.Draw(mSprite, mPosx - mWorld->getCamera()->view.x, mPosy - mWorld->getCamera()->view.y, &mSpriteClip);
+	window.DrawBatched(mSprite, mPosx - mWorld->getCamera()->view.x, mPosy - mWorld->getCamera()->view.y, &mSpriteClip);
 }
 
 Actor::Actor(GameWorld *World, SDL_Texture* sprite, float x, float y, SDL_Rect* srcClip, SDL_Rect* collisionBox, int colX, int colY)
-	:Tile(World, sprite, x, y, srcClip), mVelx(0), mVely(0), mColBoxX(colX), mColBoxY(colY), mAnimState(0), mAnimFrame(0), mNextAnimState(0)
+	:Tile(World, sprite, x, y, srcClip), mStore(World->getActorStore()), mAnimState(0), mAnimFrame(0), mNextAnimState(0),
+	mWasNotMoving(true), isMoving(false), frame3(false)
 {
 	//if no collision box provided, full image is set to collision box; otherwise, collision box is used
+	SDL_Rect box;
 	if (collisionBox == NULL)
 	{
-		mCollisionBox.x = x;
-		mCollisionBox.y = y;
-		mCollisionBox.w = getSpriteClip()->w;
-		mCollisionBox.h = getSpriteClip()->h;
+		box.x = x;
+		box.y = y;
+		box.w = getSpriteClip()->w;
+		box.h = getSpriteClip()->h;
 	}
 	else
-		mCollisionBox = *collisionBox;
+		box = *collisionBox;
+
+	mHandle = mStore->create(this, x, y, box, colX, colY);
 
-	mAnimTimer.Start();
+	mAnimStart = World->getAnimationTime();
 }
 
 Actor::~Actor()
 {
+	mStore->destroy(mHandle);
 }
 
 void Actor::moveLogic()
@@ -71,7 +73,13 @@ void Actor::moveLogic()
 
 void Actor::move(float ticks)
 {
-	//limits acceleration
+	//limits acceleration, moves position and collision box
+	mStore->integrate(index(), ticks, VELOCITY);
+	getWorld()->getSpatialHash()->update(this);
+}
+
+void Actor::limitVelocity()
+{
 	if (getVelx() > VELOCITY)
 		setVelx(VELOCITY);
 	if (getVelx() < -1 * VELOCITY)
@@ -80,14 +88,29 @@ void Actor::move(float ticks)
 		setVely(VELOCITY);
 	if (getVely() < -1 * VELOCITY)
 		setVely(-1 * VELOCITY);
+}
 
-	//move position
-	setPosx(getPosx() + getVelx() * ticks / 1000.f);
-	setPosy(getPosy() + getVely() * ticks / 1000.f);
+void Actor::setPosition(float x, float y)
+{
+	setPosx(x);
+	setPosy(y);
 
 	//moves collision box to correct position
 	getCollisionBox()->x = getPosx() + getColx();
 	getCollisionBox()->y = getPosy() + getColy();
+	getWorld()->getSpatialHash()->update(this);
+}
+
+float Actor::getDrawx()
+{
+	float prevPosx = mStore->prevX[index()];
+	return prevPosx + (getPosx() - prevPosx) * getWorld()->getInterpolation();
+}
+
+float Actor::getDrawy()
+{
+	float prevPosy = mStore->prevY[index()];
+	return prevPosy + (getPosy() - prevPosy) * getWorld()->getInterpolation();
 }
 
 void Actor::unMove(int axis, float value)
@@ -106,13 +129,15 @@ void Actor::unMove(int axis, float value)
 		setPosy(getPosy() - value);
 		getCollisionBox()->y = getPosy() + getColy();
 	}
+
+	getWorld()->getSpatialHash()->update(this);
 }
 
 void Actor::drawRect(Window &window)
 {
-	SDL_Rect colBox = mCollisionBox;
-	colBox.x -= getWorld()->getCamera()->view.x;
-	colBox.y -= getWorld()->getCamera()->view.y;
+	SDL_Rect colBox = *getCollisionBox();
+	colBox.x = getDrawx() + getColx() - getWorld()->getCamera()->view.x;
+	colBox.y = getDrawy() + getColy() - getWorld()->getCamera()->view.y;
 
 	colBox.x *= SIZE_FACTOR;
 	colBox.y *= SIZE_FACTOR;
@@ -122,7 +147,17 @@ void Actor::drawRect(Window &window)
 	window.Draw(window.getGreen(), colBox);
 }
 
-void Actor::animate()
+SDL_Rect Actor::getDrawBounds()
+{
+	SDL_Rect sprite = { static_cast<int>(getDrawx()), static_cast<int>(getDrawy()), getWorld()->getCharSprites()->tileW, getWorld()->getCharSprites()->tileH };
+	SDL_Rect colBox = { sprite.x + getColx(), sprite.y + getColy(), getCollisionBox()->w, getCollisionBox()->h };
+
+	SDL_Rect bounds;
+	SDL_UnionRect(&sprite, &colBox, &bounds);
+	return bounds;
+}
+
+void Actor::animate(double now)
 {
 	isMoving = true;		//indicates if actor is moving in this frame
 	frame3 = false;		//indicates if the "3rd frame" is being shown (same as frame 1)
@@ -173,95 +208,42 @@ void Actor::animate()
 	if (mAnimFrame == 3)
 		frame3 = true;
 
+	advanceAnimation(now);
+
+	if (mAnimFrame == 3)
+		frame3 = true;
+}
+
+void Actor::advanceAnimation(double now)
+{
+	bool moving = getVelx() != 0 || getVely() != 0;
+
 	//If the actor begins to move, immediately start playing walking animation.
-	if (isMoving && mWasNotMoving)
+	if (moving && mWasNotMoving)
 	{
 		mAnimFrame = 2;
-		mAnimTimer.Restart();
+		mAnimStart = now;
 		mWasNotMoving = false;
 	}
 
 	//Change animation frame every couple of ticks
-	bool nextFrame = mAnimTimer.Ticks() > WALK_ANIMATION_TICKS;
-	if (nextFrame)
+	if (now - mAnimStart > WALK_ANIMATION_TICKS)
 	{
-		mAnimTimer.Restart();
-
-		//RIGHT
-		if (getVelx() > 0 && getVely() == 0)
-		{
-			mAnimState = ANIM_RIGHT;
-			mAnimFrame++;
-		}
-
-		//LEFT
-		else if (getVelx() < 0 && getVely() == 0)
-		{
-			mAnimState = ANIM_LEFT;
-			mAnimFrame++;
-		}
-
-		//UP
-		else if (getVelx() == 0 && getVely() < 0)
-		{
-			mAnimState = ANIM_UP;
+		mAnimStart = now;
+		if (moving)
 			mAnimFrame++;
-		}
-
-		//DOWN
-		else if (getVelx() == 0 && getVely() > 0)
-		{
-			mAnimState = ANIM_DOWN;
-			mAnimFrame++;
-		}
-
-		//BOTTOM RIGHT
-		else if (getVelx() > 0 && getVely() > 0)
-		{
-			mAnimState = ANIM_BOTRIGHT;
-			mAnimFrame++;
-		}
-
-		//BOTTOM LEFT
-		else if (getVelx() < 0 && getVely() > 0)
-		{
-			mAnimState = ANIM_BOTLEFT;
-			mAnimFrame++;
-		}
-
-		//TOP LEFT
-		else if (getVelx() < 0 && getVely() < 0)
-		{
-			mAnimState = ANIM_TOPLEFT;
-			mAnimFrame++;
-		}
-
-		//TOP RIGHT
-		else if (getVelx() > 0 && getVely() < 0)
-		{
-			mAnimState = ANIM_TOPRIGHT;
-			mAnimFrame++;
-		}
-
-		if (mAnimFrame == 3)
-			frame3 = true;
 	}
 
-	//use window to draw objects
-	//sprites will be drawn relative to the camera view
-
 	//Reset animation upon standstill
-	if (getVelx() == 0 && getVely() == 0)
+	if (!moving)
 	{
 		mAnimFrame = 1;
 		mWasNotMoving = true;
 	}
 
-
 	//Using frame variable so that frame 3 shows same image as frame 1
 	//Allows for mAnimFrame variable to move from 0-3 freely
 	mAnimFrame = mAnimFrame % MAX_FRAMES;
-	
 }
 
 void Actor::draw(Window &window)
@@ -275,7 +257,7 @@ void Actor::draw(Window &window)
 	SDL_Rect animClip = { getSpriteClip()->x + (frame * getWorld()->getCharSprites()->tileW), getSpriteClip()->y + (mAnimState * getWorld()->getCharSprites()->tileH), 
 		getWorld()->getCharSprites()->tileW, getWorld()->getCharSprites()->tileH };
 
-	window.Draw(getSprite(), getPosx() - getWorld()->getCamera()->view.x, getPosy() - getWorld()->getCamera()->view.y, &animClip);
+	window.DrawBatched(getSprite(), getDrawx() - getWorld()->getCamera()->view.x, getDrawy() - getWorld()->getCamera()->view.y, &animClip);
 }
 
 Player::Player(GameWorld* World, SDL_Texture* sprite, float x, float y, SDL_Rect* srcClip, SDL_Rect* collisionBox, int colX, int colY)
@@ -388,6 +370,9 @@ void Player::handleInput()
 		setPosy(getWorld()->getPlayerSpawnPoint()->y);
 		setVelx(0);
 		setVely(0);
+
+		//teleporting, so the move is not interpolated
+		savePosition();
 	}
 
 	//If opposite keys are pressed, no movement
@@ -400,23 +385,8 @@ void Player::handleInput()
 
 void Player::move(float ticks)
 {
-	//limits acceleration to 0
-	if (getVelx() > VELOCITY)
-		setVelx(VELOCITY);
-	if (getVelx() < -1*VELOCITY)
-		setVelx(-1*VELOCITY);
-	if (getVely() > VELOCITY)
-		setVely(VELOCITY);
-	if (getVely() < -1*VELOCITY)
-		setVely(-1*VELOCITY);
-
-	//move position
-	setPosx(getPosx() + getVelx() * ticks / 1000.f);
-	setPosy(getPosy() + getVely() * ticks / 1000.f);
-
-	//move collision box to center of sprite
-	getCollisionBox()->x = getPosx() + getColx();
-	getCollisionBox()->y = getPosy() + getColy();
+	//limits acceleration, moves position and collision box
+	Actor::move(ticks);
 
 	//places camera around player
 	setCamera();
@@ -424,9 +394,9 @@ void Player::move(float ticks)
 
 void Player::setCamera()
 {
-	//Moves camera to center on Player.
-	getWorld()->getCamera()->view.x = getPosx() + (getSpriteClip()->w/2) - SCREEN_WIDTH/(2 * SIZE_FACTOR);
-	getWorld()->getCamera()->view.y = getPosy() + (getSpriteClip()->h / 2) - SCREEN_HEIGHT / (2 * SIZE_FACTOR);
+	//Moves camera to center on Player, where the Player is drawn.
+	getWorld()->getCamera()->view.x = getDrawx() + (getSpriteClip()->w/2) - SCREEN_WIDTH/(2 * SIZE_FACTOR);
+	getWorld()->getCamera()->view.y = getDrawy() + (getSpriteClip()->h / 2) - SCREEN_HEIGHT / (2 * SIZE_FACTOR);
 	getWorld()->getCamera()->velX = getVelx();
 	getWorld()->getCamera()->velY = getVely();
 
@@ -5,6 +5,8 @@
 #include "window.h"
 #include "gameworld.h"
 #include "timer.h"
+#include "spatialhash.h"
+#include "actorstore.h"
 
 
 #if defined(_MSC_VER)
@@ -15,6 +17,9 @@
 #include <SDL2/SDL.h>
 #endif
 
+//Actor speed is in pixels per second.
+const int VELOCITY = 65;
+
 class Tile
 {
 public:
@@ -28,6 +33,7 @@ public:
 	virtual void drawAnimate(Window &window);
 
 	//get private variables
+	//Actors keep their position in the world's ActorStore instead, see Actor::getPosx().
 	SDL_Texture* getSprite() { return mSprite; }
 	SDL_Rect* getSpriteClip() { return &mSpriteClip; }
 	GameWorld* getWorld() { return mWorld; }
@@ -47,6 +53,8 @@ private:
 
 };
 
+//An Actor's position, velocity and collision box are stored in the world's ActorStore.
+//The Actor is a view of its index in the store, found through its handle.
 class Actor : public Tile
 {
 public:
@@ -58,6 +66,19 @@ public:
 	//Move actor based on velocity.
 	virtual void move(float ticks);
 
+	//Limits velocity to the maximum speed on each axis.
+	void limitVelocity();
+
+	//Places the actor at a position, moving its collision box along with it.
+	void setPosition(float x, float y);
+
+	//Remembers the current position as the position at the previous simulation tick.
+	void savePosition() { mStore->prevX[index()] = getPosx(); mStore->prevY[index()] = getPosy(); }
+
+	//Position to draw the actor at, interpolated between the previous and the current simulation tick.
+	float getDrawx();
+	float getDrawy();
+
 	//Unmove actors due to collision detection; should only be used by detectCollision().
 	virtual void unMove(int axis, float value);
 
@@ -69,30 +90,50 @@ public:
 	bool detectCollision(SDL_Rect &B);
 
 	//get private variables
-	SDL_Rect* getCollisionBox() { return &mCollisionBox; }
-	float getVelx() const { return mVelx; }
-	float getVely() const { return mVely; }
-	int getColx() const { return mColBoxX; }
-	int getColy() const { return mColBoxY; }
+	//The collision box moves in memory when other Actors are spawned or destroyed, so the pointer should not be kept.
+	SDL_Rect* getCollisionBox() { return &mStore->boxes[index()]; }
+	HashEntry* getHashEntry() { return &mHashEntry; }
+	ActorHandle getHandle() const { return mHandle; }
+	float getPosx() const { return mStore->posX[index()]; }
+	float getPosy() const { return mStore->posY[index()]; }
+	float getVelx() const { return mStore->velX[index()]; }
+	float getVely() const { return mStore->velY[index()]; }
+	int getColx() const { return mStore->colX[index()]; }
+	int getColy() const { return mStore->colY[index()]; }
 	int getAnimFrame() const { return mAnimFrame; }
 	int getAnimState() const { return mAnimState; }
 
 	//set private variables
-	void setVelx(float value) { mVelx = value; }
-	void setVely(float value) { mVely = value; }
+	void setPosx(float value) { mStore->posX[index()] = value; }
+	void setPosy(float value) { mStore->posY[index()] = value; }
+	void setVelx(float value) { mStore->velX[index()] = value; }
+	void setVely(float value) { mStore->velY[index()] = value; }
 	int setAnimFrame(int frame) { mAnimFrame = frame; }
 	int setAnimState(int status) { mAnimState = status; }
 
+	//Returns the rectangle covered by the sprite and the collision box where the Actor is drawn, in level pixels.
+	SDL_Rect getDrawBounds();
+
 	//animate moving actors
-	virtual void animate();
+	//@param now The world's animation time, see GameWorld::getAnimationTime()
+	virtual void animate(double now);
+
+	//Advances the animation frame only, without turning the Actor to face where it moves.
+	//Cheap enough to call for every Actor that is not drawn, so that animations stay in step when Actors come into view.
+	void advanceAnimation(double now);
+
 	virtual void draw(Window& window);
+	virtual void drawAnimate(Window &window) { animate(getWorld()->getAnimationTime()); draw(window); }
 
 private:
-	float mVelx, mVely;				 //x and y velocities
-	SDL_Rect mCollisionBox;          //collision box rectangle
-	int mColBoxX, mColBoxY;			 //collision box offset position relative to sprite position
+	//Return the Actor's index in the store.
+	int index() const { return mStore->indexOf(mHandle); }
+
+	ActorStore* mStore;				 //the world's store of Actor positions, velocities and collision boxes
+	ActorHandle mHandle;			 //handle of the Actor in mStore
+	HashEntry mHashEntry;			 //cells of the world's spatial hash the collision box is stored in
 	int mAnimFrame, mAnimState, mNextAnimState; //ints indicating which frame and direction the sprite should be animated in
-	Timer mAnimTimer;				 //timer for animation
+	double mAnimStart;				 //animation time the current frame started at
 	bool mWasNotMoving;				 //boolean indicating whether the actor was not moving last frame
 	bool isMoving;					 //boolean indicating whether the actor is moving this frame
 	bool frame3;					 //boolean indicating whether the sprite is in "frame 3", which is the same as frame 1 (not frame 0)
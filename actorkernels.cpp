@@ -0,0 +1,239 @@
+#include "actorkernels.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define KERNELS_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+#include <immintrin.h>
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+//Clamps a velocity to [-maxSpeed, maxSpeed], giving the same result as the min and max of the vector paths.
+static inline float clampSpeed(float velocity, float maxSpeed)
+{
+	return velocity > maxSpeed ? maxSpeed : (velocity < -maxSpeed ? -maxSpeed : velocity);
+}
+
+//Integrates Actors from first up to count one at a time. Also finishes the Actors left over by the vector paths.
+static void integrateScalar(int first, float* posX, float* posY, float* velX, float* velY,
+	const int* colX, const int* colY, SDL_Rect* boxes, int count, float ticks, float maxSpeed)
+{
+	for (int i = first; i < count; i++)
+	{
+		velX[i] = clampSpeed(velX[i], maxSpeed);
+		velY[i] = clampSpeed(velY[i], maxSpeed);
+		posX[i] += velX[i] * ticks / 1000.f;
+		posY[i] += velY[i] * ticks / 1000.f;
+		boxes[i].x = static_cast<int>(posX[i] + colX[i]);
+		boxes[i].y = static_cast<int>(posY[i] + colY[i]);
+	}
+}
+
+static void overlapScalar(int first, const SDL_Rect &box, const int* x, const int* y, const int* w, const int* h,
+	int count, unsigned char* hits)
+{
+	for (int i = first; i < count; i++)
+	{
+		hits[i] = (box.y + box.h > y[i] && box.y < y[i] + h[i] &&
+			box.x < x[i] + w[i] && box.x + box.w > x[i]) ? 1 : 0;
+	}
+}
+
+#ifdef KERNELS_X86
+
+//The vector paths handle Actors and boxes in groups of 4 or 8 and return how many they handled.
+//The scalar path finishes the rest.
+TARGET_SSE2 static int integrateSSE2(float* posX, float* posY, float* velX, float* velY,
+	const int* colX, const int* colY, SDL_Rect* boxes, int count, float ticks, float maxSpeed)
+{
+	__m128 maxVel = _mm_set1_ps(maxSpeed);
+	__m128 minVel = _mm_set1_ps(-maxSpeed);
+	__m128 tickVec = _mm_set1_ps(ticks);
+	__m128 thousand = _mm_set1_ps(1000.f);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 vx = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(velX + i), minVel), maxVel);
+		__m128 vy = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(velY + i), minVel), maxVel);
+		__m128 px = _mm_add_ps(_mm_loadu_ps(posX + i), _mm_div_ps(_mm_mul_ps(vx, tickVec), thousand));
+		__m128 py = _mm_add_ps(_mm_loadu_ps(posY + i), _mm_div_ps(_mm_mul_ps(vy, tickVec), thousand));
+		_mm_storeu_ps(velX + i, vx);
+		_mm_storeu_ps(velY + i, vy);
+		_mm_storeu_ps(posX + i, px);
+		_mm_storeu_ps(posY + i, py);
+
+		//truncating conversion, as static_cast<int> does
+		__m128 cx = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(colX + i)));
+		__m128 cy = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(colY + i)));
+		int bx[4], by[4];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(bx), _mm_cvttps_epi32(_mm_add_ps(px, cx)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(by), _mm_cvttps_epi32(_mm_add_ps(py, cy)));
+		for (int j = 0; j < 4; j++)
+		{
+			boxes[i + j].x = bx[j];
+			boxes[i + j].y = by[j];
+		}
+	}
+	return i;
+}
+
+TARGET_SSE2 static int overlapSSE2(const SDL_Rect &box, const int* x, const int* y, const int* w, const int* h,
+	int count, unsigned char* hits)
+{
+	__m128i left = _mm_set1_epi32(box.x);
+	__m128i right = _mm_set1_epi32(box.x + box.w);
+	__m128i top = _mm_set1_epi32(box.y);
+	__m128i bottom = _mm_set1_epi32(box.y + box.h);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i leftB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+		__m128i topB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i));
+		__m128i rightB = _mm_add_epi32(leftB, _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + i)));
+		__m128i bottomB = _mm_add_epi32(topB, _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i)));
+
+		__m128i overlap = _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi32(bottom, topB), _mm_cmplt_epi32(top, bottomB)),
+			_mm_and_si128(_mm_cmplt_epi32(left, rightB), _mm_cmpgt_epi32(right, leftB)));
+
+		int mask = _mm_movemask_ps(_mm_castsi128_ps(overlap));
+		for (int j = 0; j < 4; j++)
+			hits[i + j] = static_cast<unsigned char>((mask >> j) & 1);
+	}
+	return i;
+}
+
+TARGET_AVX2 static int integrateAVX2(float* posX, float* posY, float* velX, float* velY,
+	const int* colX, const int* colY, SDL_Rect* boxes, int count, float ticks, float maxSpeed)
+{
+	__m256 maxVel = _mm256_set1_ps(maxSpeed);
+	__m256 minVel = _mm256_set1_ps(-maxSpeed);
+	__m256 tickVec = _mm256_set1_ps(ticks);
+	__m256 thousand = _mm256_set1_ps(1000.f);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 vx = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(velX + i), minVel), maxVel);
+		__m256 vy = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(velY + i), minVel), maxVel);
+		__m256 px = _mm256_add_ps(_mm256_loadu_ps(posX + i), _mm256_div_ps(_mm256_mul_ps(vx, tickVec), thousand));
+		__m256 py = _mm256_add_ps(_mm256_loadu_ps(posY + i), _mm256_div_ps(_mm256_mul_ps(vy, tickVec), thousand));
+		_mm256_storeu_ps(velX + i, vx);
+		_mm256_storeu_ps(velY + i, vy);
+		_mm256_storeu_ps(posX + i, px);
+		_mm256_storeu_ps(posY + i, py);
+
+		__m256 cx = _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(colX + i)));
+		__m256 cy = _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(colY + i)));
+		int bx[8], by[8];
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(bx), _mm256_cvttps_epi32(_mm256_add_ps(px, cx)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(by), _mm256_cvttps_epi32(_mm256_add_ps(py, cy)));
+		for (int j = 0; j < 8; j++)
+		{
+			boxes[i + j].x = bx[j];
+			boxes[i + j].y = by[j];
+		}
+	}
+	return i;
+}
+
+TARGET_AVX2 static int overlapAVX2(const SDL_Rect &box, const int* x, const int* y, const int* w, const int* h,
+	int count, unsigned char* hits)
+{
+	__m256i left = _mm256_set1_epi32(box.x);
+	__m256i right = _mm256_set1_epi32(box.x + box.w);
+	__m256i top = _mm256_set1_epi32(box.y);
+	__m256i bottom = _mm256_set1_epi32(box.y + box.h);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i leftB = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+		__m256i topB = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i));
+		__m256i rightB = _mm256_add_epi32(leftB, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i)));
+		__m256i bottomB = _mm256_add_epi32(topB, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i)));
+
+		//AVX2 only has a greater than comparison, so a < b is written as b > a
+		__m256i overlap = _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi32(bottom, topB), _mm256_cmpgt_epi32(bottomB, top)),
+			_mm256_and_si256(_mm256_cmpgt_epi32(rightB, left), _mm256_cmpgt_epi32(right, leftB)));
+
+		int mask = _mm256_movemask_ps(_mm256_castsi256_ps(overlap));
+		for (int j = 0; j < 8; j++)
+			hits[i + j] = static_cast<unsigned char>((mask >> j) & 1);
+	}
+	return i;
+}
+
+#endif
+
+void integrateActors(KernelPath path, float* posX, float* posY, float* velX, float* velY,
+	const int* colX, const int* colY, SDL_Rect* boxes, int count, float ticks, float maxSpeed)
+{
+	int done = 0;
+
+#ifdef KERNELS_X86
+	if (path == KERNEL_AVX2)
+		done = integrateAVX2(posX, posY, velX, velY, colX, colY, boxes, count, ticks, maxSpeed);
+	else if (path == KERNEL_SSE2)
+		done = integrateSSE2(posX, posY, velX, velY, colX, colY, boxes, count, ticks, maxSpeed);
+#endif
+
+	integrateScalar(done, posX, posY, velX, velY, colX, colY, boxes, count, ticks, maxSpeed);
+}
+
+void overlapBoxes(KernelPath path, const SDL_Rect &box, const int* x, const int* y, const int* w, const int* h,
+	int count, unsigned char* hits)
+{
+	int done = 0;
+
+#ifdef KERNELS_X86
+	if (path == KERNEL_AVX2)
+		done = overlapAVX2(box, x, y, w, h, count, hits);
+	else if (path == KERNEL_SSE2)
+		done = overlapSSE2(box, x, y, w, h, count, hits);
+#endif
+
+	overlapScalar(done, box, x, y, w, h, count, hits);
+}
+
+bool kernelPathSupported(KernelPath path)
+{
+	if (path == KERNEL_SCALAR)
+		return true;
+
+#ifdef KERNELS_X86
+	if (path == KERNEL_SSE2)
+		return SDL_HasSSE2() == SDL_TRUE;
+	return SDL_HasAVX2() == SDL_TRUE;
+#else
+	return false;
+#endif
+}
+
+KernelPath bestKernelPath()
+{
+	//checking the CPU only once
+	static const KernelPath best = kernelPathSupported(KERNEL_AVX2) ? KERNEL_AVX2 :
+		kernelPathSupported(KERNEL_SSE2) ? KERNEL_SSE2 : KERNEL_SCALAR;
+	return best;
+}
+
+const char* kernelPathName(KernelPath path)
+{
+	switch (path)
+	{
+	case KERNEL_AVX2:
+		return "avx2";
+	case KERNEL_SSE2:
+		return "sse2";
+	default:
+		return "scalar";
+	}
+}
@@ -0,0 +1,43 @@
+#ifndef ACTORKERNELS_H
+#define ACTORKERNELS_H
+
+#if defined(_MSC_VER)
+#include <SDL.h>
+#elif defined(__clang__)
+#include <SDL2/SDL.h>
+#else
+#include <SDL2/SDL.h>
+#endif
+
+//Batch kernels over the arrays of the ActorStore, with SSE2 and AVX2 versions picked at runtime.
+//Every path gives bit for bit the same results as the scalar path, which --bench checks.
+
+//The kernel paths available.
+enum KernelPath
+{
+	KERNEL_SCALAR,
+	KERNEL_SSE2,	//4 actors or boxes per instruction
+	KERNEL_AVX2		//8 actors or boxes per instruction
+};
+
+//Moves count Actors by their velocity over ticks milliseconds, as ActorStore::integrate() does:
+//clamps each velocity to maxSpeed on both axes, advances each position and moves each collision box to the
+//position plus its offset, rounded towards zero. Only x and y of the boxes are written.
+void integrateActors(KernelPath path, float* posX, float* posY, float* velX, float* velY,
+	const int* colX, const int* colY, SDL_Rect* boxes, int count, float ticks, float maxSpeed);
+
+//Tests one box against count boxes given as separate arrays of x, y, w and h.
+//hits[i] is set to 1 if the box overlaps box i as detectOverlap() defines it, where touching edges do not overlap, and to 0 otherwise.
+void overlapBoxes(KernelPath path, const SDL_Rect &box, const int* x, const int* y, const int* w, const int* h,
+	int count, unsigned char* hits);
+
+//Returns the fastest path supported by the CPU.
+KernelPath bestKernelPath();
+
+//Returns whether the CPU supports a path.
+bool kernelPathSupported(KernelPath path);
+
+//Returns a readable name for a path.
+const char* kernelPathName(KernelPath path);
+
+#endif
@@ -0,0 +1,97 @@
+#include "actorstore.h"
+#include "actorkernels.h"
+
+ActorStore::ActorStore()
+{
+}
+
+ActorHandle ActorStore::create(Actor* owner, float x, float y, const SDL_Rect &box, int offsetX, int offsetY)
+{
+	ActorHandle handle;
+	if (!mFreeHandles.empty())
+	{
+		handle = mFreeHandles.back();
+		mFreeHandles.pop_back();
+	}
+	else
+	{
+		handle = static_cast<ActorHandle>(mIndices.size());
+		mIndices.push_back(-1);
+	}
+
+	mIndices[handle] = size();
+	mHandles.push_back(handle);
+
+	posX.push_back(x);
+	posY.push_back(y);
+	prevX.push_back(x);
+	prevY.push_back(y);
+	velX.push_back(0);
+	velY.push_back(0);
+	boxes.push_back(box);
+	colX.push_back(offsetX);
+	colY.push_back(offsetY);
+	owners.push_back(owner);
+
+	return handle;
+}
+
+void ActorStore::destroy(ActorHandle handle)
+{
+	int index = mIndices[handle];
+	int last = size() - 1;
+
+	//moving the last Actor into the free index, so the arrays stay packed
+	if (index != last)
+	{
+		posX[index] = posX[last];
+		posY[index] = posY[last];
+		prevX[index] = prevX[last];
+		prevY[index] = prevY[last];
+		velX[index] = velX[last];
+		velY[index] = velY[last];
+		boxes[index] = boxes[last];
+		colX[index] = colX[last];
+		colY[index] = colY[last];
+		owners[index] = owners[last];
+		mHandles[index] = mHandles[last];
+		mIndices[mHandles[index]] = index;
+	}
+
+	posX.pop_back();
+	posY.pop_back();
+	prevX.pop_back();
+	prevY.pop_back();
+	velX.pop_back();
+	velY.pop_back();
+	boxes.pop_back();
+	colX.pop_back();
+	colY.pop_back();
+	owners.pop_back();
+	mHandles.pop_back();
+
+	mIndices[handle] = -1;
+	mFreeHandles.push_back(handle);
+}
+
+void ActorStore::savePositions()
+{
+	prevX = posX;
+	prevY = posY;
+}
+
+void ActorStore::integrate(float ticks, float maxSpeed)
+{
+	if (size() == 0)
+		return;
+
+	integrateActors(bestKernelPath(), &posX[0], &posY[0], &velX[0], &velY[0], &colX[0], &colY[0], &boxes[0],
+		size(), ticks, maxSpeed);
+}
+
+void ActorStore::integrate(int index, float ticks, float maxSpeed)
+{
+	//the scalar kernel on a single Actor, so that moving Actors one at a time gives the same result as moving them all at once
+	integrateActors(KERNEL_SCALAR, &posX[index], &posY[index], &velX[index], &velY[index], &colX[index], &colY[index], &boxes[index],
+		1, ticks, maxSpeed);
+}
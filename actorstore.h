@@ -0,0 +1,75 @@
+#ifndef ACTORSTORE_H
+#define ACTORSTORE_H
+
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <SDL.h>
+#elif defined(__clang__)
+#include <SDL2/SDL.h>
+#else
+#include <SDL2/SDL.h>
+#endif
+
+class Actor;
+
+//Identifies an Actor in the ActorStore. A handle stays valid until its Actor is destroyed,
+//while the Actor's index in the arrays may change whenever another Actor is destroyed.
+typedef int ActorHandle;
+const ActorHandle NO_ACTOR = -1;
+
+//Struct of arrays holding the movement state of every Actor: position, velocity and collision box.
+//Each Actor is a thin view of one index of the arrays, so that the integrate step runs over contiguous memory
+//instead of chasing an Actor pointer and making virtual calls per Actor. The arrays are packed;
+//destroying an Actor moves the last Actor into its index.
+class ActorStore
+{
+public:
+	ActorStore();
+
+	//Adds an Actor at rest and returns its handle.
+	//@param owner The Actor viewing the new index
+	//@param x, y The position of the Actor's sprite
+	//@param box The collision box in level pixels
+	//@param offsetX, offsetY The offset of the collision box from the sprite position
+	ActorHandle create(Actor* owner, float x, float y, const SDL_Rect &box, int offsetX, int offsetY);
+
+	//Removes an Actor. Its handle may be reused by a later create().
+	void destroy(ActorHandle handle);
+
+	//Return the index of an Actor in the arrays.
+	int indexOf(ActorHandle handle) const { return mIndices[handle]; }
+
+	//Return the number of Actors.
+	int size() const { return static_cast<int>(owners.size()); }
+
+	//Remembers every position as the position at the previous simulation tick.
+	void savePositions();
+
+	//Moves every Actor by its velocity over ticks milliseconds: clamps the velocity to maxSpeed on each axis,
+	//advances the position and moves the collision box along. Collisions are not checked.
+	//Uses the fastest kernel of actorkernels.h the CPU supports.
+	void integrate(float ticks, float maxSpeed);
+
+	//Moves one Actor like integrate().
+	void integrate(int index, float ticks, float maxSpeed);
+
+	//Indexed by the index of an Actor.
+	std::vector<float> posX, posY;		//sprite position
+	std::vector<float> prevX, prevY;	//sprite position at the previous simulation tick
+	std::vector<float> velX, velY;		//velocity in pixels per second
+	std::vector<SDL_Rect> boxes;		//collision box; x and y follow the position, rounded towards zero
+	std::vector<int> colX, colY;		//collision box offset relative to the sprite position
+	std::vector<Actor*> owners;			//Actor viewing each index
+
+private:
+	std::vector<int> mIndices;			//index of each handle, or -1 for handles that are free
+	std::vector<ActorHandle> mHandles;	//handle of each index
+	std::vector<ActorHandle> mFreeHandles;
+
+	//The arrays are referenced by their Actors and are not copied.
+	ActorStore(const ActorStore&);
+	ActorStore& operator= (const ActorStore&);
+};
+
+#endif
@@ -0,0 +1,263 @@
+#include "atlas.h"
+#include "texturecache.h"
+
+#include <algorithm>
+#include <set>
+
+SkylinePacker::SkylinePacker(int width, int height)
+	:mWidth(width), mHeight(height)
+{
+	Segment floor = { 0, 0, width };
+	mSkyline.push_back(floor);
+}
+
+int SkylinePacker::fit(size_t index, int w, int h) const
+{
+	int x = mSkyline[index].x;
+	if (x + w > mWidth)
+		return -1;
+
+	//the rectangle rests on the highest segment under it
+	int y = 0;
+	int remaining = w;
+	for (size_t i = index; remaining > 0 && i < mSkyline.size(); i++)
+	{
+		y = std::max(y, mSkyline[i].y);
+		remaining -= mSkyline[i].w;
+	}
+
+	if (y + h > mHeight)
+		return -1;
+	return y;
+}
+
+bool SkylinePacker::pack(int w, int h, SDL_Point* position)
+{
+	if (w <= 0 || h <= 0)
+		return false;
+
+	//finding the segment where the rectangle's top is lowest, and the narrowest segment among those
+	int bestIndex = -1;
+	int bestTop = mHeight + 1;
+	int bestWidth = mWidth + 1;
+	for (size_t i = 0; i < mSkyline.size(); i++)
+	{
+		int y = fit(i, w, h);
+		if (y < 0)
+			continue;
+
+		if (y + h < bestTop || (y + h == bestTop && mSkyline[i].w < bestWidth))
+		{
+			bestIndex = static_cast<int>(i);
+			bestTop = y + h;
+			bestWidth = mSkyline[i].w;
+		}
+	}
+
+	if (bestIndex < 0)
+		return false;
+
+	position->x = mSkyline[bestIndex].x;
+	position->y = bestTop - h;
+
+	//the rectangle's top becomes a new segment, covering the segments under it
+	Segment top = { position->x, bestTop, w };
+	mSkyline.insert(mSkyline.begin() + bestIndex, top);
+
+	for (size_t i = bestIndex + 1; i < mSkyline.size();)
+	{
+		int covered = top.x + top.w - mSkyline[i].x;
+		if (covered <= 0)
+			break;
+
+		mSkyline[i].x += covered;
+		mSkyline[i].w -= covered;
+		if (mSkyline[i].w > 0)
+			break;
+		mSkyline.erase(mSkyline.begin() + i);
+	}
+
+	//merging neighbouring segments of the same height
+	for (size_t i = 0; i + 1 < mSkyline.size();)
+	{
+		if (mSkyline[i].y == mSkyline[i + 1].y)
+		{
+			mSkyline[i].w += mSkyline[i + 1].w;
+			mSkyline.erase(mSkyline.begin() + i + 1);
+		}
+		else
+			i++;
+	}
+
+	return true;
+}
+
+TextureAtlas::TextureAtlas()
+	:mRenderer(NULL), mPageWidth(0), mPageHeight(0)
+{
+}
+
+TextureAtlas::~TextureAtlas()
+{
+	clear();
+}
+
+//Orders textures from tallest to shortest, then widest to narrowest, which the skyline packs tightest.
+struct TallestFirst
+{
+	bool operator() (const std::pair<SDL_Texture*, SDL_Point> &A, const std::pair<SDL_Texture*, SDL_Point> &B) const
+	{
+		if (A.second.y != B.second.y)
+			return A.second.y > B.second.y;
+		return A.second.x > B.second.x;
+	}
+};
+
+void TextureAtlas::build(SDL_Renderer* renderer, const std::vector<SDL_Texture*> &textures)
+{
+	clear();
+
+	mRenderer = renderer;
+	if (renderer == NULL || SDL_RenderTargetSupported(renderer) != SDL_TRUE)
+		return;
+
+	SDL_RendererInfo info;
+	mPageWidth = ATLAS_PAGE_SIZE;
+	mPageHeight = ATLAS_PAGE_SIZE;
+	if (SDL_GetRendererInfo(renderer, &info) == 0)
+	{
+		if (info.max_texture_width > 0)
+			mPageWidth = std::min(mPageWidth, info.max_texture_width);
+		if (info.max_texture_height > 0)
+			mPageHeight = std::min(mPageHeight, info.max_texture_height);
+	}
+
+	//sizes of the textures, without duplicates
+	std::vector<std::pair<SDL_Texture*, SDL_Point> > sized;
+	std::set<SDL_Texture*> seen;
+	for (std::vector<SDL_Texture*>::const_iterator iter = textures.begin(); iter != textures.end(); iter++)
+	{
+		if (*iter == NULL || !seen.insert(*iter).second)
+			continue;
+
+		SDL_Point size;
+		if (SDL_QueryTexture(*iter, NULL, NULL, &size.x, &size.y) == 0)
+			sized.push_back(std::make_pair(*iter, size));
+	}
+	std::stable_sort(sized.begin(), sized.end(), TallestFirst());
+
+	//each texture goes in the first page it fits in, with a new page started when none has room
+	std::vector<SkylinePacker> packers;
+	std::vector<int> usedHeights;
+	for (size_t i = 0; i < sized.size(); i++)
+	{
+		int w = sized[i].second.x + ATLAS_PADDING;
+		int h = sized[i].second.y + ATLAS_PADDING;
+		if (w > mPageWidth || h > mPageHeight)
+			continue;
+
+		Placement placement = { -1, { 0, 0 }, sized[i].second.x, sized[i].second.y };
+		for (size_t page = 0; page < packers.size() && placement.page < 0; page++)
+		{
+			if (packers[page].pack(w, h, &placement.offset))
+				placement.page = static_cast<int>(page);
+		}
+
+		if (placement.page < 0)
+		{
+			packers.push_back(SkylinePacker(mPageWidth, mPageHeight));
+			usedHeights.push_back(0);
+			if (!packers.back().pack(w, h, &placement.offset))
+				continue;
+			placement.page = static_cast<int>(packers.size()) - 1;
+		}
+
+		usedHeights[placement.page] = std::max(usedHeights[placement.page], placement.offset.y + h);
+		mPlacements[sized[i].first] = placement;
+	}
+
+	//pages are only as tall as what was packed into them
+	for (size_t page = 0; page < packers.size(); page++)
+	{
+		SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, mPageWidth, usedHeights[page]);
+		if (texture == NULL)
+		{
+			//the textures of a page that cannot be created are drawn on their own
+			clear();
+			return;
+		}
+
+		SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+		mPages.push_back(texture);
+	}
+
+	redraw();
+}
+
+void TextureAtlas::redraw()
+{
+	if (mPages.empty())
+		return;
+
+	//Saving the render target and draw color, as the pages are cleared to transparent.
+	SDL_Texture* previousTarget = SDL_GetRenderTarget(mRenderer);
+	Uint8 r, g, b, a;
+	SDL_GetRenderDrawColor(mRenderer, &r, &g, &b, &a);
+	SDL_SetRenderDrawColor(mRenderer, 0, 0, 0, 0);
+
+	for (int page = 0; page < static_cast<int>(mPages.size()); page++)
+	{
+		SDL_SetRenderTarget(mRenderer, mPages[page]);
+		SDL_RenderClear(mRenderer);
+
+		for (std::map<SDL_Texture*, Placement>::iterator iter = mPlacements.begin(); iter != mPlacements.end(); iter++)
+		{
+			if (iter->second.page == page)
+				copy(iter->first, iter->second);
+		}
+	}
+
+	SDL_SetRenderTarget(mRenderer, previousTarget);
+	SDL_SetRenderDrawColor(mRenderer, r, g, b, a);
+}
+
+void TextureAtlas::copy(SDL_Texture* texture, const Placement &placement)
+{
+	//copying the pixels as they are, alpha included, instead of blending them onto the cleared page
+	SDL_BlendMode mode;
+	SDL_GetTextureBlendMode(texture, &mode);
+	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+
+	SDL_Rect destination = { placement.offset.x, placement.offset.y, placement.w, placement.h };
+	SDL_RenderCopy(mRenderer, texture, NULL, &destination);
+
+	SDL_SetTextureBlendMode(texture, mode);
+}
+
+void TextureAtlas::clear()
+{
+	for (std::vector<SDL_Texture*>::iterator iter = mPages.begin(); iter != mPages.end(); iter++)
+		SDL_DestroyTexture(*iter);
+
+	mPages.clear();
+	mPlacements.clear();
+}
+
+bool TextureAtlas::find(SDL_Texture* texture, SDL_Texture** page, SDL_Point* offset) const
+{
+	std::map<SDL_Texture*, Placement>::const_iterator found = mPlacements.find(texture);
+	if (found == mPlacements.end() || found->second.page < 0)
+		return false;
+
+	*page = mPages[found->second.page];
+	*offset = found->second.offset;
+	return true;
+}
+
+Uint64 TextureAtlas::getMemory() const
+{
+	Uint64 bytes = 0;
+	for (std::vector<SDL_Texture*>::const_iterator iter = mPages.begin(); iter != mPages.end(); iter++)
+		bytes += textureBytes(*iter);
+	return bytes;
+}
@@ -0,0 +1,105 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include <vector>
+#include <map>
+
+#if defined(_MSC_VER)
+#include <SDL.h>
+#elif defined(__clang__)
+#include <SDL2/SDL.h>
+#else
+#include <SDL2/SDL.h>
+#endif
+
+//Width and height of an atlas page, unless the renderer cannot create textures that large.
+const int ATLAS_PAGE_SIZE = 2048;
+
+//Transparent pixels left between packed images, so that filtering never blends in a neighbouring image.
+const int ATLAS_PADDING = 1;
+
+//Packs rectangles into a fixed size area with the skyline bottom-left heuristic.
+//The skyline is the top edge of everything packed so far, kept as a list of horizontal segments. Each rectangle
+//is placed on the segment where its top ends up lowest, which keeps the wasted space under the skyline small
+//when rectangles are packed from tallest to shortest.
+class SkylinePacker
+{
+public:
+	SkylinePacker(int width, int height);
+
+	//Finds a place for a w x h rectangle and marks it as used.
+	//Returns false, leaving the packer unchanged, if the rectangle does not fit anywhere.
+	bool pack(int w, int h, SDL_Point* position);
+
+private:
+	struct Segment
+	{
+		int x, y, w;
+	};
+
+	//Returns the y a w x h rectangle would be placed at if its left edge were at segment index,
+	//or -1 if it does not fit there.
+	int fit(size_t index, int w, int h) const;
+
+	int mWidth, mHeight;
+	std::vector<Segment> mSkyline;		//ordered by x, covering the whole width
+};
+
+//Images copied into a few large render target textures, so that drawing tiles and sprites from several images
+//does not switch textures, and the sprite batch of Window can draw them together.
+//The source textures are kept by their owners; the atlas only remembers where each one was copied to.
+class TextureAtlas
+{
+public:
+	TextureAtlas();
+
+	//Destroys the pages.
+	~TextureAtlas();
+
+	//Destroys the previous pages and packs the textures into new ones, tallest first.
+	//Textures that are NULL, listed twice or too large for a page are skipped, as is everything if the renderer
+	//does not support render targets. Skipped textures are simply drawn on their own.
+	void build(SDL_Renderer* renderer, const std::vector<SDL_Texture*> &textures);
+
+	//Copies every texture into its place again. Render target contents are lost when the renderer resets them.
+	void redraw();
+
+	//Destroys the pages and forgets every texture.
+	void clear();
+
+	//Finds where a texture was packed. Returns false if it was not packed.
+	//@param texture The source texture
+	//@param page Set to the page the texture was copied into
+	//@param offset Set to the position of the texture's top left corner in the page
+	bool find(SDL_Texture* texture, SDL_Texture** page, SDL_Point* offset) const;
+
+	int getPageCount() const { return static_cast<int>(mPages.size()); }
+
+	//Memory taken by the pages, in bytes, see textureBytes().
+	Uint64 getMemory() const;
+
+	//Number of textures packed.
+	int getSize() const { return static_cast<int>(mPlacements.size()); }
+
+private:
+	struct Placement
+	{
+		int page;
+		SDL_Point offset;
+		int w, h;
+	};
+
+	//Copies a packed texture into its page. The page has to be the render target.
+	void copy(SDL_Texture* texture, const Placement &placement);
+
+	SDL_Renderer* mRenderer;
+	int mPageWidth, mPageHeight;
+	std::vector<SDL_Texture*> mPages;
+	std::map<SDL_Texture*, Placement> mPlacements;
+
+	//Pages are owned by the atlas and are not copied.
+	TextureAtlas(const TextureAtlas&);
+	TextureAtlas& operator= (const TextureAtlas&);
+};
+
+#endif
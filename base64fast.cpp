@@ -0,0 +1,262 @@
+#include "base64fast.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define BASE64_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#define TARGET_SSSE3
+#define TARGET_AVX2
+#else
+#include <immintrin.h>
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+//Special values of the decoding table for characters that are not base64 digits.
+const unsigned char WHITESPACE = 0x80;
+const unsigned char PADDING = 0x81;
+const unsigned char INVALID = 0xFF;
+
+//Table giving the 6 bit value of each base64 character, or one of the special values above.
+struct DecodeTable
+{
+	DecodeTable()
+	{
+		const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+		for (int i = 0; i < 256; i++)
+			value[i] = INVALID;
+		for (int i = 0; i < 64; i++)
+			value[static_cast<unsigned char>(alphabet[i])] = static_cast<unsigned char>(i);
+
+		value[' '] = WHITESPACE;
+		value['\t'] = WHITESPACE;
+		value['\r'] = WHITESPACE;
+		value['\n'] = WHITESPACE;
+		value['='] = PADDING;
+	}
+
+	unsigned char value[256];
+};
+
+static const DecodeTable decodeTable;
+
+//Decodes one group of up to four base64 digits, skipping whitespace.
+//Returns false, without consuming anything, if decoding should stop before this group.
+static bool decodeGroup(const char* &src, const char* end, unsigned char* &dst, unsigned char* dstEnd)
+{
+	const char* in = src;
+	unsigned char digits[4];
+	int numDigits = 0;
+
+	while (numDigits < 4 && in != end)
+	{
+		unsigned char value = decodeTable.value[static_cast<unsigned char>(*in)];
+		if (value == WHITESPACE)
+		{
+			in++;
+			continue;
+		}
+		if (value >= 64)
+			break;
+
+		digits[numDigits++] = value;
+		in++;
+	}
+
+	//A group of n digits holds n - 1 bytes. A single digit holds no whole byte.
+	int numBytes = numDigits - 1;
+	if (numBytes <= 0 || dstEnd - dst < numBytes)
+		return false;
+
+	dst[0] = static_cast<unsigned char>((digits[0] << 2) | (digits[1] >> 4));
+	if (numBytes > 1)
+		dst[1] = static_cast<unsigned char>((digits[1] << 4) | (digits[2] >> 2));
+	if (numBytes > 2)
+		dst[2] = static_cast<unsigned char>((digits[2] << 6) | digits[3]);
+
+	dst += numBytes;
+	src = in;
+
+	//a partial group ends the data
+	return numDigits == 4;
+}
+
+#ifdef BASE64_X86
+
+//The vector decoders follow Wojciech Mula and Daniel Lemire's method: the characters are validated and translated to
+//6 bit values with nibble lookups, then packed into bytes with multiply-adds and a shuffle.
+//A block holding any other character, including whitespace, is left for decodeGroup().
+
+//Decodes 16 characters into 12 bytes. Writes 16 bytes to dst. Returns false if the block has non-base64 characters.
+TARGET_SSSE3 static bool decodeBlockSSSE3(const char* src, unsigned char* dst)
+{
+	const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+	const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m128i mask2F = _mm_set1_epi8(0x2F);
+
+	__m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+
+	//validating and translating
+	__m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask2F);
+	__m128i loNibbles = _mm_and_si128(str, mask2F);
+	__m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+	__m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+	if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0)
+		return false;
+
+	__m128i eq2F = _mm_cmpeq_epi8(str, mask2F);
+	__m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles));
+	str = _mm_add_epi8(str, roll);
+
+	//packing four 6 bit values into three bytes
+	__m128i mergeAB = _mm_maddubs_epi16(str, _mm_set1_epi32(0x01400140));
+	str = _mm_madd_epi16(mergeAB, _mm_set1_epi32(0x00011000));
+	str = _mm_shuffle_epi8(str, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), str);
+	return true;
+}
+
+//Decodes 32 characters into 24 bytes. Writes 32 bytes to dst. Returns false if the block has non-base64 characters.
+TARGET_AVX2 static bool decodeBlockAVX2(const char* src, unsigned char* dst)
+{
+	const __m256i lutLo = _mm256_setr_epi8(
+		0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+		0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+	const __m256i lutHi = _mm256_setr_epi8(
+		0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+		0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m256i lutRoll = _mm256_setr_epi8(
+		0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m256i mask2F = _mm256_set1_epi8(0x2F);
+
+	__m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+
+	//validating and translating
+	__m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask2F);
+	__m256i loNibbles = _mm256_and_si256(str, mask2F);
+	__m256i lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+	__m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+	if (!_mm256_testz_si256(lo, hi))
+		return false;
+
+	__m256i eq2F = _mm256_cmpeq_epi8(str, mask2F);
+	__m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles));
+	str = _mm256_add_epi8(str, roll);
+
+	//packing four 6 bit values into three bytes, then moving the two 12 byte halves together
+	__m256i mergeAB = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+	str = _mm256_madd_epi16(mergeAB, _mm256_set1_epi32(0x00011000));
+	str = _mm256_shuffle_epi8(str, _mm256_setr_epi8(
+		2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+		2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+	str = _mm256_permutevar8x32_epi32(str, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), str);
+	return true;
+}
+
+#endif
+
+size_t base64_decode_path(Base64Path path, const char* src, size_t srcLen, unsigned char* dst, size_t dstLen, size_t* srcUsed)
+{
+	const char* in = src;
+	const char* end = src + srcLen;
+	unsigned char* out = dst;
+	unsigned char* dstEnd = dst + dstLen;
+
+	for (;;)
+	{
+#ifdef BASE64_X86
+		//Vector blocks are tried while there is room for their full stores; decodeGroup() handles the rest.
+		if (path == BASE64_AVX2)
+		{
+			while (end - in >= 32 && dstEnd - out >= 32 && decodeBlockAVX2(in, out))
+			{
+				in += 32;
+				out += 24;
+			}
+		}
+		if (path != BASE64_SCALAR)
+		{
+			while (end - in >= 16 && dstEnd - out >= 16 && decodeBlockSSSE3(in, out))
+			{
+				in += 16;
+				out += 12;
+			}
+		}
+#endif
+
+		if (!decodeGroup(in, end, out, dstEnd))
+			break;
+	}
+
+	if (srcUsed != NULL)
+		*srcUsed = in - src;
+	return out - dst;
+}
+
+bool base64_path_supported(Base64Path path)
+{
+	if (path == BASE64_SCALAR)
+		return true;
+
+#ifdef BASE64_X86
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	bool ssse3 = (info[2] & (1 << 9)) != 0;
+	if (path == BASE64_SSSE3)
+		return ssse3;
+
+	//AVX2 needs the OS to save the upper halves of the ymm registers
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	if (maxLeaf < 7 || !osxsave || (_xgetbv(0) & 6) != 6)
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	if (path == BASE64_SSSE3)
+		return __builtin_cpu_supports("ssse3") != 0;
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+#else
+	return false;
+#endif
+}
+
+Base64Path base64_best_path()
+{
+	//checking the CPU only once
+	static const Base64Path best = base64_path_supported(BASE64_AVX2) ? BASE64_AVX2 :
+		base64_path_supported(BASE64_SSSE3) ? BASE64_SSSE3 : BASE64_SCALAR;
+	return best;
+}
+
+size_t base64_decode_fast(const char* src, size_t srcLen, unsigned char* dst, size_t dstLen, size_t* srcUsed)
+{
+	return base64_decode_path(base64_best_path(), src, srcLen, dst, dstLen, srcUsed);
+}
+
+const char* base64_path_name(Base64Path path)
+{
+	switch (path)
+	{
+	case BASE64_AVX2:
+		return "avx2";
+	case BASE64_SSSE3:
+		return "ssse3";
+	default:
+		return "scalar";
+	}
+}
@@ -0,0 +1,40 @@
+#ifndef BASE64FAST_H
+#define BASE64FAST_H
+
+#include <cstddef>
+
+//Fast base64 decoding for TMX layer data.
+//base64.cpp decodes into a std::string one character at a time; these functions decode straight into a caller's buffer
+//using a lookup table, and use SSSE3 or AVX2 when the CPU supports them.
+
+//The decoding paths available. The fastest path supported by the CPU is picked at runtime.
+enum Base64Path
+{
+	BASE64_SCALAR,
+	BASE64_SSSE3,
+	BASE64_AVX2
+};
+
+//Decodes base64 text into dst, skipping any whitespace.
+//Decoding stops at the end of the text, at padding or at an invalid character, or when dst cannot hold the next group of bytes.
+//@param src The base64 text
+//@param srcLen The number of characters in src
+//@param dst The buffer to decode into
+//@param dstLen The size of dst in bytes
+//@param srcUsed If not NULL, set to the number of characters of src that were decoded
+//@return The number of bytes written to dst
+size_t base64_decode_fast(const char* src, size_t srcLen, unsigned char* dst, size_t dstLen, size_t* srcUsed = NULL);
+
+//Same as base64_decode_fast(), using a specific path. The path must be supported by the CPU.
+size_t base64_decode_path(Base64Path path, const char* src, size_t srcLen, unsigned char* dst, size_t dstLen, size_t* srcUsed = NULL);
+
+//Returns the fastest path supported by the CPU.
+Base64Path base64_best_path();
+
+//Returns whether the CPU supports a path.
+bool base64_path_supported(Base64Path path);
+
+//Returns a readable name for a path.
+const char* base64_path_name(Base64Path path);
+
+#endif
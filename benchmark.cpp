@@ -0,0 +1,645 @@
+#include "benchmark.h"
+#include "actor.h"
+#include "base64.h"
+#include "base64fast.h"
+#include "actorkernels.h"
+#include "mapgen.h"
+#include "timer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+//Speed of the wandering Actors in the headless benchmark, and how many ticks they keep going in one direction.
+const float WANDER_SPEED = 65.f;
+const int WANDER_TICKS = 60;
+
+//GameWorld::spawnActor() places the collision box this far below the Actor's position.
+const int SPAWN_COLLISION_Y = 50;
+
+//Returns the size of a level in tiles, such as "1024x1024", to name workloads.
+static std::string levelSize(Level* level)
+{
+	std::ostringstream size;
+	size << level->getWidth() << "x" << level->getHeight();
+	return size.str();
+}
+
+//Writes a string as a JSON string literal.
+static void writeJsonString(std::ostream &out, const std::string &text)
+{
+	out << '"';
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		if (text[i] == '"' || text[i] == '\\')
+			out << '\\';
+		out << text[i];
+	}
+	out << '"';
+}
+
+void BenchReport::add(const std::string &benchmark, const std::string &workload, double value, const std::string &unit)
+{
+	Result result;
+	result.benchmark = benchmark;
+	result.workload = workload;
+	result.value = value;
+	result.unit = unit;
+	mResults.push_back(result);
+}
+
+bool BenchReport::writeJson(const std::string &file) const
+{
+	std::ofstream out(file.c_str());
+	if (!out)
+		return false;
+
+	out.precision(6);
+	out << "{\n\t\"results\": [";
+	for (size_t i = 0; i < mResults.size(); i++)
+	{
+		out << (i == 0 ? "\n" : ",\n") << "\t\t{ \"benchmark\": ";
+		writeJsonString(out, mResults[i].benchmark);
+		out << ", \"workload\": ";
+		writeJsonString(out, mResults[i].workload);
+		out << ", \"value\": " << mResults[i].value << ", \"unit\": ";
+		writeJsonString(out, mResults[i].unit);
+		out << " }";
+	}
+	out << "\n\t]\n}\n";
+
+	return !out.fail();
+}
+
+void benchSolidLookup(Level* level, BenchReport &report, int probes)
+{
+	if (level == NULL || probes <= 0)
+		return;
+
+	//Generating the probe coordinates up front, so that only the lookups are timed.
+	std::vector<int> probeX(probes), probeY(probes);
+	srand(1);
+	for (int i = 0; i < probes; i++)
+	{
+		probeX[i] = rand() % level->getWidth();
+		probeY[i] = rand() % level->getHeight();
+	}
+
+	TileLayer* background = level->getTileMap();
+	TileLayer* background2 = level->getTileMap2();
+	std::set<int>* solidGid = level->getSolidGid();
+
+	//The hit counts are printed so that the lookups cannot be optimized away, and so that the three methods can be checked against each other.
+	int setHits = 0, tableHits = 0, bitmapHits = 0;
+
+	//std::set lookup, as collision detection used to do it
+	Timer timer;
+	timer.Start();
+	for (int i = 0; i < probes; i++)
+	{
+		if (solidGid->find(background->at(probeX[i], probeY[i])) != solidGid->end()
+			|| solidGid->find(background2->at(probeX[i], probeY[i])) != solidGid->end())
+			setHits++;
+	}
+	double setMs = timer.Milliseconds();
+
+	//dense gid table
+	timer.Start();
+	for (int i = 0; i < probes; i++)
+	{
+		if (level->isSolidGid(background->at(probeX[i], probeY[i])) || level->isSolidGid(background2->at(probeX[i], probeY[i])))
+			tableHits++;
+	}
+	double tableMs = timer.Milliseconds();
+
+	//per tile solid bitmap
+	timer.Start();
+	for (int i = 0; i < probes; i++)
+	{
+		if (level->isSolid(probeX[i], probeY[i]))
+			bitmapHits++;
+	}
+	double bitmapMs = timer.Milliseconds();
+
+	std::cout << "Solid lookup, " << probes << " probes on a " << level->getWidth() << "x" << level->getHeight() << " level" << std::endl;
+	std::cout << "  std::set:    " << setMs << " ms (" << setHits << " solid)" << std::endl;
+	std::cout << "  gid table:   " << tableMs << " ms (" << tableHits << " solid)" << std::endl;
+	std::cout << "  solid bits:  " << bitmapMs << " ms (" << bitmapHits << " solid)" << std::endl;
+
+	std::string workload = levelSize(level);
+	report.add("solid lookup std::set", workload, setMs * 1000000.0 / probes, "ns/probe");
+	report.add("solid lookup gid table", workload, tableMs * 1000000.0 / probes, "ns/probe");
+	report.add("solid lookup solid bits", workload, bitmapMs * 1000000.0 / probes, "ns/probe");
+}
+
+bool benchBase64Decode(BenchReport &report, int size)
+{
+	//Encoding random data, as a stand in for a large layer.
+	std::vector<unsigned char> data(size);
+	srand(1);
+	for (int i = 0; i < size; i++)
+		data[i] = static_cast<unsigned char>(rand());
+	std::string encoded = base64_encode(&data[0], size);
+
+	double megabytes = size / (1024.0 * 1024.0);
+	std::cout << "Base64 decode, " << megabytes << " MB decoded" << std::endl;
+
+	Timer timer;
+	timer.Start();
+	std::string decoded = base64_decode(encoded);
+	double ms = timer.Milliseconds();
+	bool allCorrect = decoded.size() == data.size() && memcmp(decoded.data(), &data[0], data.size()) == 0;
+	std::cout << "  base64_decode: " << megabytes * 1000.0 / ms << " MB/s" << (allCorrect ? "" : " (wrong output)") << std::endl;
+	report.add("base64_decode", "random data", megabytes * 1000.0 / ms, "MB/s");
+	report.add("base64 exact base64_decode", "random data", allCorrect ? 1 : 0, "bool");
+
+	std::vector<unsigned char> output(size);
+	Base64Path paths[] = { BASE64_SCALAR, BASE64_SSSE3, BASE64_AVX2 };
+	for (int i = 0; i < 3; i++)
+	{
+		if (!base64_path_supported(paths[i]))
+			continue;
+
+		timer.Start();
+		size_t written = base64_decode_path(paths[i], encoded.data(), encoded.size(), &output[0], output.size());
+		ms = timer.Milliseconds();
+
+		bool correct = written == data.size() && output == data;
+		std::cout << "  " << base64_path_name(paths[i]) << ": " << megabytes * 1000.0 / ms << " MB/s" << (correct ? "" : " (wrong output)") << std::endl;
+		report.add(std::string("base64_decode_fast ") + base64_path_name(paths[i]), "random data", megabytes * 1000.0 / ms, "MB/s");
+		report.add(std::string("base64 exact ") + base64_path_name(paths[i]), "random data", correct ? 1 : 0, "bool");
+		allCorrect = allCorrect && correct;
+	}
+	return allCorrect;
+}
+
+//Returns a random float from -range to range.
+static float randomFloat(float range)
+{
+	return (rand() / static_cast<float>(RAND_MAX) * 2.f - 1.f) * range;
+}
+
+bool benchKernels(BenchReport &report, int count, int runs)
+{
+	if (count <= 0 || runs <= 0)
+		return true;
+
+	//Random Actors, some of them faster than the speed limit so that clamping is exercised.
+	srand(1);
+	std::vector<float> posX(count), posY(count), velX(count), velY(count);
+	std::vector<int> colX(count), colY(count);
+	std::vector<SDL_Rect> boxes(count);
+	for (int i = 0; i < count; i++)
+	{
+		posX[i] = randomFloat(10000.f);
+		posY[i] = randomFloat(10000.f);
+		velX[i] = randomFloat(2.f * VELOCITY);
+		velY[i] = randomFloat(2.f * VELOCITY);
+		colX[i] = rand() % 32;
+		colY[i] = rand() % 64;
+		boxes[i].x = 0;
+		boxes[i].y = 0;
+		boxes[i].w = 1 + rand() % 32;
+		boxes[i].h = 1 + rand() % 32;
+	}
+
+	//Random boxes around a box in the middle, about half of them overlapping it.
+	std::vector<int> x(count), y(count), w(count), h(count);
+	for (int i = 0; i < count; i++)
+	{
+		x[i] = rand() % 128 - 64;
+		y[i] = rand() % 128 - 64;
+		w[i] = rand() % 48;
+		h[i] = rand() % 48;
+	}
+	SDL_Rect box = { -16, -16, 32, 32 };
+
+	std::cout << "Actor kernels, " << count << " actors, " << runs << " runs" << std::endl;
+
+	std::vector<float> scalarX, scalarY;
+	std::vector<SDL_Rect> scalarBoxes;
+	std::vector<unsigned char> scalarHits;
+	bool allExact = true;
+	KernelPath paths[] = { KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2 };
+	for (int p = 0; p < 3; p++)
+	{
+		if (!kernelPathSupported(paths[p]))
+			continue;
+
+		//every path integrates the same Actors, so the results can be compared after the same number of runs
+		std::vector<float> px = posX, py = posY, vx = velX, vy = velY;
+		std::vector<SDL_Rect> bx = boxes;
+		Timer timer;
+		timer.Start();
+		for (int run = 0; run < runs; run++)
+			integrateActors(paths[p], &px[0], &py[0], &vx[0], &vy[0], &colX[0], &colY[0], &bx[0], count, SIMULATION_STEP, VELOCITY);
+		double integrateMs = timer.Milliseconds();
+
+		std::vector<unsigned char> hits(count);
+		timer.Start();
+		for (int run = 0; run < runs; run++)
+			overlapBoxes(paths[p], box, &x[0], &y[0], &w[0], &h[0], count, &hits[0]);
+		double overlapMs = timer.Milliseconds();
+
+		bool exact = true;
+		if (paths[p] == KERNEL_SCALAR)
+		{
+			scalarX = px;
+			scalarY = py;
+			scalarBoxes = bx;
+			scalarHits = hits;
+		}
+		else
+		{
+			exact = memcmp(&px[0], &scalarX[0], count * sizeof(float)) == 0 && memcmp(&py[0], &scalarY[0], count * sizeof(float)) == 0 &&
+				memcmp(&bx[0], &scalarBoxes[0], count * sizeof(SDL_Rect)) == 0 && hits == scalarHits;
+		}
+
+		double integrateNs = integrateMs * 1000000.0 / (static_cast<double>(count) * runs);
+		double overlapNs = overlapMs * 1000000.0 / (static_cast<double>(count) * runs);
+		std::cout << "  " << kernelPathName(paths[p]) << ": integrate " << integrateNs << " ns/actor, overlap " << overlapNs << " ns/box"
+			<< (exact ? "" : " (MISMATCH with scalar)") << std::endl;
+
+		std::string name = kernelPathName(paths[p]);
+		report.add("integrateActors " + name, "random actors", integrateNs, "ns/actor");
+		report.add("overlapBoxes " + name, "random boxes", overlapNs, "ns/box");
+		report.add("kernels exact " + name, "random actors", exact ? 1 : 0, "bool");
+		allExact = allExact && exact;
+	}
+	return allExact;
+}
+
+void benchText(Window* window, const std::string &font, BenchReport &report, int frames)
+{
+	const int FONT_SIZE = 16;
+	SDL_Color white = { 255, 255, 255, 255 };
+
+	//text like a performance readout, which changes every frame
+	std::vector<std::string> lines(3);
+
+	double renderMs = 0, drawMs = 0;
+	int renderCalls = 0, drawCalls = 0;
+	Timer timer;
+	try
+	{
+		for (int frame = 0; frame < frames; frame++)
+		{
+			std::ostringstream fps, frameTime, actors;
+			fps << "FPS: " << 60 - frame % 7;
+			frameTime << "Frame: " << 16.6 + (frame % 13) * 0.1 << " ms";
+			actors << "Actors: " << 1000 + frame % 100 << " drawn, " << frame % 50 << " culled";
+			lines[0] = fps.str();
+			lines[1] = frameTime.str();
+			lines[2] = actors.str();
+
+			window->resetDrawCalls();
+			timer.Start();
+			for (int line = 0; line < 3; line++)
+			{
+				SDL_Texture* texture = window->RenderText(lines[line], font, white, FONT_SIZE);
+				window->Draw(texture, 0, line * FONT_SIZE);
+				SDL_DestroyTexture(texture);
+			}
+			renderMs += timer.Milliseconds();
+			renderCalls += window->getDrawCalls();
+
+			window->resetDrawCalls();
+			timer.Start();
+			window->DrawString(lines[0] + "\n" + lines[1] + "\n" + lines[2], font, FONT_SIZE, white, 0, 0);
+			window->FlushBatch();
+			drawMs += timer.Milliseconds();
+			drawCalls += window->getDrawCalls();
+		}
+	}
+	catch (const std::runtime_error &error)
+	{
+		std::cout << "Text: " << error.what() << std::endl;
+		return;
+	}
+
+	std::cout << "Text, 3 lines, " << frames << " frames" << std::endl;
+	std::cout << "  RenderText: " << renderMs / frames << " ms per frame, " << renderCalls / frames << " draw calls" << std::endl;
+	std::cout << "  DrawString: " << drawMs / frames << " ms per frame, " << drawCalls / frames << " draw calls, "
+		<< window->getGlyphCache()->getPageCount() << " glyph pages" << std::endl;
+
+	report.add("RenderText", "3 lines", renderMs / frames, "ms");
+	report.add("DrawString", "3 lines", drawMs / frames, "ms");
+	report.add("DrawString draw calls", "3 lines", drawCalls / frames, "calls");
+}
+
+void benchMapLoad(GameWorld* world, const std::vector<std::string> &maps, BenchReport &report, int runs)
+{
+	if (maps.empty() || runs <= 0)
+		return;
+
+	std::cout << "Map load, average of " << runs << " runs" << std::endl;
+
+	for (std::vector<std::string>::const_iterator map = maps.begin(); map != maps.end(); map++)
+	{
+		TextureCache* textures = world->getWin()->getTextureCache();
+		int hits = textures->getHits();
+		int misses = textures->getMisses();
+
+		Timer timer;
+		timer.Start();
+		for (int i = 0; i < runs; i++)
+			world->openMap(*map);
+		double ms = timer.Milliseconds() / runs;
+
+		//images the next load shares with the open level are found in the texture cache
+		hits = textures->getHits() - hits;
+		misses = textures->getMisses() - misses;
+
+		std::cout << "  " << *map << ": " << ms << " ms (" << levelSize(world->getLevel()) << "), texture cache "
+			<< hits << " hits, " << misses << " misses, " << textures->getSize() << " textures" << std::endl;
+		report.add("openMap", *map, ms, "ms");
+		report.add("openMap texture cache hits", *map, hits, "hits");
+		report.add("openMap texture cache misses", *map, misses, "misses");
+	}
+}
+
+//Gives every Actor but the player a new random direction.
+static void wander(GameWorld* world)
+{
+	std::vector<Actor*>* actors = world->getActorList();
+	for (std::vector<Actor*>::iterator iter = actors->begin(); iter != actors->end(); iter++)
+	{
+		if (*iter == world->getPlayer())
+			continue;
+
+		(*iter)->setVelx((rand() % 3 - 1) * WANDER_SPEED);
+		(*iter)->setVely((rand() % 3 - 1) * WANDER_SPEED);
+	}
+}
+
+//Spawns Actors on random free tiles of the opened level, each collision box inside its own tile.
+static void spawnWanderers(GameWorld* world, int actors)
+{
+	Level* level = world->getLevel();
+
+	srand(1);
+	int tileW = level->getTileWidth();
+	int tileH = level->getTileHeight();
+	for (int spawned = 0, tries = 0; spawned < actors && tries < actors * 100; tries++)
+	{
+		int x = rand() % level->getWidth();
+		int y = rand() % level->getHeight();
+		if (level->isSolid(x, y))
+			continue;
+
+		SDL_Rect box = { x * tileW, y * tileH, tileW - 1, tileH - 1 };
+		SDL_Rect clip = world->getCharClip(0);
+		world->spawnActor(world->getCharImage(), box.x, box.y - SPAWN_COLLISION_Y, &box, &clip);
+		spawned++;
+	}
+}
+
+void benchCollision(GameWorld* world, BenchReport &report, int passes)
+{
+	Level* level = world->getLevel();
+	std::vector<Actor*>* actors = world->getActorList();
+	if (level == NULL || actors->empty() || passes <= 0)
+		return;
+
+	double overlapMs = 0, collisionMs = 0;
+	int overlapTiles = 0;
+	Timer timer;
+	for (int pass = 0; pass < passes; pass++)
+	{
+		//moving the Actors is not timed, only finding and correcting their collisions
+		if (pass % WANDER_TICKS == 0)
+			wander(world);
+		for (std::vector<Actor*>::iterator iter = actors->begin(); iter != actors->end(); iter++)
+			(*iter)->move(SIMULATION_STEP);
+
+		timer.Start();
+		for (std::vector<Actor*>::iterator iter = actors->begin(); iter != actors->end(); iter++)
+		{
+			SDL_Rect tiles = world->tileRangeOverlap(*(*iter)->getCollisionBox());
+			overlapTiles += tiles.w * tiles.h;
+		}
+		overlapMs += timer.Milliseconds();
+
+		timer.Start();
+		for (std::vector<Actor*>::iterator iter = actors->begin(); iter != actors->end(); iter++)
+			world->correctCollision(iter);
+		collisionMs += timer.Milliseconds();
+	}
+
+	double calls = static_cast<double>(passes) * actors->size();
+	std::cout << "Collision, " << actors->size() << " actors on a " << levelSize(level) << " level, " << passes << " passes" << std::endl;
+	std::cout << "  tileRangeOverlap:  " << overlapMs * 1000000.0 / calls << " ns/actor (" << overlapTiles / calls << " tiles)" << std::endl;
+	std::cout << "  correctCollision:  " << collisionMs * 1000000.0 / calls << " ns/actor" << std::endl;
+
+	std::ostringstream workload;
+	workload << levelSize(level) << ", " << actors->size() << " actors";
+	report.add("tileRangeOverlap", workload.str(), overlapMs * 1000000.0 / calls, "ns/actor");
+	report.add("correctCollision", workload.str(), collisionMs * 1000000.0 / calls, "ns/actor");
+}
+
+void benchDrawActors(GameWorld* world, BenchReport &report, int runs)
+{
+	std::vector<Actor*>* actors = world->getActorList();
+	if (world->getLevel() == NULL || actors->empty() || runs <= 0)
+		return;
+
+	Window* window = world->getWin();
+
+	//the first run sorts the Actors from spawn order, later runs only restore the order after they moved
+	world->drawActors();
+	window->FlushBatch();
+	window->resetDrawCalls();
+
+	double ms = 0;
+	Timer timer;
+	for (int i = 0; i < runs; i++)
+	{
+		//moving the Actors is not timed, only drawing them
+		if (i % WANDER_TICKS == 0)
+			wander(world);
+		world->moveActors();
+
+		timer.Start();
+		world->drawActors();
+		window->FlushBatch();
+		ms += timer.Milliseconds();
+	}
+	ms /= runs;
+	int drawCalls = window->getDrawCalls() / runs;
+	int sprites = window->getSpritesDrawn() / runs;
+
+	std::cout << "drawActors, " << actors->size() << " actors" << std::endl;
+	std::cout << "  " << ms << " ms, " << drawCalls << " draw calls for " << sprites << " sprites, " << world->getActorsDrawn() << " actors drawn, "
+		<< world->getActorsCulled() << " culled" << std::endl;
+
+	std::ostringstream workload;
+	workload << levelSize(world->getLevel()) << ", " << actors->size() << " actors";
+	report.add("drawActors", workload.str(), ms, "ms");
+	report.add("drawActors draw calls", workload.str(), drawCalls, "calls");
+	report.add("drawActors sprites", workload.str(), sprites, "sprites");
+	report.add("drawActors culled", workload.str(), world->getActorsCulled(), "actors");
+}
+
+void benchDrawBackground(GameWorld* world, BenchReport &report)
+{
+	Level* level = world->getLevel();
+	if (level == NULL)
+		return;
+
+	//Putting the camera in the middle of the level, where the view is filled with tiles.
+	Camera* camera = world->getCamera();
+	SDL_Rect savedView = camera->view;
+	camera->view.x = std::max(0, level->getWidth() * level->getTileWidth() / 2 - camera->view.w / SIZE_FACTOR / 2);
+	camera->view.y = std::max(0, level->getHeight() * level->getTileHeight() / 2 - camera->view.h / SIZE_FACTOR / 2);
+
+	//cold bakes the chunks in view, warm draws them from the cache, and tiles draws tile by tile without the cache
+	const char* passes[] = { "cold", "warm", "tiles" };
+	Window* window = world->getWin();
+	std::string workload = levelSize(level);
+	std::cout << "drawBackground, " << workload << " level" << std::endl;
+
+	//tiles and characters are drawn from the atlas pages built when the level was opened
+	TextureAtlas* atlas = world->getAtlas();
+	std::cout << "  atlas: " << atlas->getSize() << " images in " << atlas->getPageCount() << " pages, "
+		<< atlas->getMemory() / (1024.0 * 1024.0) << " MB" << std::endl;
+	report.add("atlas images", workload, atlas->getSize(), "images");
+	report.add("atlas pages", workload, atlas->getPageCount(), "pages");
+	report.add("atlas memory", workload, atlas->getMemory() / (1024.0 * 1024.0), "MB");
+
+	//the chunk cache is disabled for the tiles pass, keeping the level's apron, which drawTiles() also uses
+	ChunkCache* chunks = world->getChunkCache();
+	int chunkWidth = chunks->getChunkWidth();
+	int chunkHeight = chunks->getChunkHeight();
+	int apronX = chunks->getApronX();
+	int apronY = chunks->getApronY();
+
+	for (int pass = 0; pass < 3; pass++)
+	{
+		if (pass == 2)
+			chunks->reset(NULL, chunkWidth, chunkHeight, apronX, apronY);
+
+		window->resetDrawCalls();
+		Timer timer;
+		timer.Start();
+		for (int layer = 0; layer < NUM_LAYERS; layer++)
+			world->drawBackground(level->getLayer(layer));
+		window->FlushBatch();
+		double ms = timer.Milliseconds();
+
+		std::cout << "  " << passes[pass] << ": " << ms << " ms, " << window->getDrawCalls() << " draw calls for "
+			<< window->getSpritesDrawn() << " sprites" << std::endl;
+		report.add(std::string("drawBackground ") + passes[pass], workload, ms, "ms");
+		report.add(std::string("drawBackground ") + passes[pass] + " draw calls", workload, window->getDrawCalls(), "calls");
+		report.add(std::string("drawBackground ") + passes[pass] + " sprites", workload, window->getSpritesDrawn(), "sprites");
+	}
+
+	chunks->reset(window->getRenderer(), chunkWidth, chunkHeight, apronX, apronY);
+	camera->view = savedView;
+}
+
+bool runBenchmarks(GameWorld* world, const BenchSettings &settings)
+{
+	BenchReport report;
+
+	bool passed = benchBase64Decode(report);
+	passed = benchKernels(report) && passed;
+	if (settings.font != "")
+		benchText(world->getWin(), settings.font, report);
+
+	for (std::vector<int>::const_iterator size = settings.sizes.begin(); size != settings.sizes.end(); size++)
+	{
+		MapGenSettings mapSettings;
+		mapSettings.width = *size;
+		mapSettings.height = *size;
+		mapSettings.layers = settings.layers;
+		mapSettings.tilesets = settings.tilesets;
+		mapSettings.solidDensity = settings.solidDensity;
+
+		std::ostringstream file;
+		file << "bench" << *size << ".tmx";
+		std::string map = file.str();
+		std::string cache = getMapCachePath(map);
+		writeGeneratedMap(map, mapSettings);
+
+		//the first load parses the map and writes its cache, the next ones read the cache
+		std::remove(cache.c_str());
+		Timer timer;
+		timer.Start();
+		world->openMap(map);
+		double coldMs = timer.Milliseconds();
+
+		std::cout << "openMap, " << levelSize(world->getLevel()) << " level" << std::endl;
+		std::cout << "  cold: " << coldMs << " ms" << std::endl;
+		report.add("openMap cold", levelSize(world->getLevel()), coldMs, "ms");
+
+		std::vector<std::string> maps(1, map);
+		benchMapLoad(world, maps, report);
+
+		benchSolidLookup(world->getLevel(), report);
+		benchDrawBackground(world, report);
+
+		spawnWanderers(world, settings.actors);
+		benchCollision(world, report);
+		benchDrawActors(world, report);
+
+		//the cache stays mapped while the level is open
+		world->closeLevel();
+		std::remove(map.c_str());
+		std::remove(cache.c_str());
+	}
+
+	benchMapLoad(world, settings.maps, report);
+
+	if (settings.json != "")
+	{
+		if (report.writeJson(settings.json))
+			std::cout << "Results written to " << settings.json << std::endl;
+		else
+			std::cout << "Could not write " << settings.json << std::endl;
+	}
+
+	if (!passed)
+		std::cout << "Correctness checks failed: a base64 decoder or kernel path gives the wrong results" << std::endl;
+	return passed;
+}
+
+void benchHeadless(GameWorld* world, int ticks, int actors)
+{
+	Level* level = world->getLevel();
+	if (level == NULL || ticks <= 0)
+		return;
+
+	spawnWanderers(world, actors);
+
+	FrameStats* stats = world->getStats();
+	stats->reset();
+	world->enableStats(true);
+
+	Timer timer;
+	timer.Start();
+	for (int i = 0; i < ticks; i++)
+	{
+		if (i % WANDER_TICKS == 0)
+			wander(world);
+		world->moveActors();
+	}
+	double ms = timer.Milliseconds();
+
+	world->enableStats(false);
+
+	//phase times are summed over all ticks in performance counter ticks
+	double counterMs = 1000.0 / Timer::Frequency();
+
+	std::cout << "Headless simulation, " << ticks << " ticks, " << world->getActorList()->size() << " actors on a "
+		<< level->getWidth() << "x" << level->getHeight() << " level" << std::endl;
+	std::cout << "  " << ticks * 1000.0 / ms << " ticks/s, " << ms / ticks << " ms per tick ("
+		<< SIMULATION_STEP << " ms is real time)" << std::endl;
+	std::cout << "  logic:      " << stats->logicTime * counterMs / ticks << " ms per tick" << std::endl;
+	std::cout << "  move:       " << stats->moveTime * counterMs / ticks << " ms per tick" << std::endl;
+	std::cout << "  collision:  " << stats->collisionTime * counterMs / ticks << " ms per tick" << std::endl;
+}
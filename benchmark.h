@@ -0,0 +1,145 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include "gameworld.h"
+
+//Benchmarks, run from main.cpp with the --bench command line option.
+//The suite runs on synthetic maps from mapgen.h in a headless window, so results only depend on the build and the machine.
+//Results are written to standard output, and as JSON with --json so that releases can be compared.
+
+//Collects the results of a benchmark run.
+class BenchReport
+{
+public:
+	//Adds a result.
+	//@param benchmark What was measured, such as "openMap cold"
+	//@param workload What it was measured on, such as "1024x1024"
+	//@param value The measurement
+	//@param unit The unit of the measurement, such as "ms"
+	void add(const std::string &benchmark, const std::string &workload, double value, const std::string &unit);
+
+	//Writes all results to a JSON file. Returns false if the file cannot be written.
+	bool writeJson(const std::string &file) const;
+
+private:
+	struct Result
+	{
+		std::string benchmark;
+		std::string workload;
+		double value;
+		std::string unit;
+	};
+
+	std::vector<Result> mResults;
+};
+
+//Workloads of the benchmark suite.
+struct BenchSettings
+{
+	BenchSettings()
+		:layers(2), tilesets(2), solidDensity(0.1f), actors(1000)
+	{
+		sizes.push_back(64);
+		sizes.push_back(256);
+		sizes.push_back(1024);
+		sizes.push_back(4096);
+	}
+
+	//Width and height in tiles of each synthetic map.
+	std::vector<int> sizes;
+
+	//Tile layers, tilesets and solid tile density of the synthetic maps, see MapGenSettings.
+	int layers;
+	int tilesets;
+	float solidDensity;
+
+	//Number of Actors spawned for the collision and drawing benchmarks.
+	int actors;
+
+	//Other .tmx files to time loading.
+	std::vector<std::string> maps;
+
+	//Font to time drawing text with, or an empty string to skip the text benchmark.
+	std::string font;
+
+	//File to write the results to as JSON, or an empty string for none.
+	std::string json;
+};
+
+//Runs every benchmark. Synthetic maps are written to the working directory while they are benchmarked, and removed afterwards.
+//Returns false if a correctness check failed, such as a kernel path not matching the scalar path. Every benchmark still runs,
+//and the results are still written, so that a failed run can be inspected.
+//@param world The world to open the maps in. Its window should be headless, so that tiles are drawn by the software renderer.
+//@param settings The workloads to run
+bool runBenchmarks(GameWorld* world, const BenchSettings &settings);
+
+//Compares the cost of probing tile solidity through the std::set of solid gids,
+//the dense gid solidity table and the per tile solid bitmap.
+//@param level The opened level to probe
+//@param report The report to add the results to
+//@param probes The number of random tiles to probe
+void benchSolidLookup(Level* level, BenchReport &report, int probes = 1000000);
+
+//Measures the throughput of base64_decode() and of every base64_decode_fast() path supported by the CPU, and checks
+//that each one decodes the data exactly. Mismatches are reported, and recorded as an exact value of 0.
+//Returns false if any decoder gives the wrong output.
+//@param report The report to add the results to
+//@param size The number of bytes of random data to encode and decode
+bool benchBase64Decode(BenchReport &report, int size = 16 * 1024 * 1024);
+
+//Runs the actor kernels of actorkernels.h on every path supported by the CPU, and checks that each path gives
+//bit for bit the same results as the scalar path. Mismatches are reported, and recorded as an exact value of 0.
+//Returns false if any path does not match the scalar path.
+//@param report The report to add the results to
+//@param count The number of random Actors and boxes
+//@param runs The number of times each kernel is run
+bool benchKernels(BenchReport &report, int count = 100000, int runs = 100);
+
+//Compares drawing a few lines of text every frame with Window::RenderText(), which renders a new texture each time,
+//and with Window::DrawString(), which draws cached glyphs through the sprite batch.
+//@param window The window to draw in
+//@param font The font to draw with
+//@param report The report to add the results to
+//@param frames The number of times the text is drawn
+void benchText(Window* window, const std::string &font, BenchReport &report, int frames = 1000);
+
+//Measures how long GameWorld::openMap() takes for each map, averaged over several runs.
+//Pass maps saved with each layer compression (none, zlib, gzip, zstd) to compare the encodings.
+//The last map stays open afterwards.
+//@param world The world to open the maps in
+//@param maps The .tmx files to load
+//@param report The report to add the results to
+//@param runs The number of times each map is loaded
+void benchMapLoad(GameWorld* world, const std::vector<std::string> &maps, BenchReport &report, int runs = 5);
+
+//Measures GameWorld::tileRangeOverlap() and GameWorld::correctCollision() over every Actor of the opened level,
+//with the Actors wandering between passes.
+//@param world The world, with a map opened and Actors spawned
+//@param report The report to add the results to
+//@param passes The number of times every Actor is corrected
+void benchCollision(GameWorld* world, BenchReport &report, int passes = 100);
+
+//Measures GameWorld::drawActors(), which culls the Actors out of view and restores the depth order of the rest before drawing them, and counts its draw calls and sprites.
+//The Actors wander between runs, so that the order changes as it does in game.
+//@param world The world, with a map opened and Actors spawned
+//@param report The report to add the results to
+//@param runs The number of times the Actors are drawn
+void benchDrawActors(GameWorld* world, BenchReport &report, int runs = 100);
+
+//Counts the draw calls and sprites of GameWorld::drawBackground() for every layer with the camera in the middle of the level,
+//with the chunk cache cold, warm and disabled, and measures how long each takes.
+//@param world The world, with a map opened
+//@param report The report to add the results to
+void benchDrawBackground(GameWorld* world, BenchReport &report);
+
+//Spawns Actors that wander the opened map in random directions and runs the simulation as fast as it goes, without drawing.
+//Reports the ticks per second and the time per tick of each phase of GameWorld::moveActors().
+//Run with --headless, so that no display is needed.
+//@param world The world to simulate, with a map opened
+//@param ticks The number of simulation ticks to run
+//@param actors The number of Actors to spawn on free tiles
+void benchHeadless(GameWorld* world, int ticks, int actors);
+
+#endif
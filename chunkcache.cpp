@@ -0,0 +1,70 @@
+#include "chunkcache.h"
+
+ChunkCache::ChunkCache(int capacity)
+	:mRenderer(NULL), mCapacity(capacity), mChunkWidth(0), mChunkHeight(0), mApronX(0), mApronY(0), mEnabled(false)
+{
+}
+
+ChunkCache::~ChunkCache()
+{
+	clear();
+}
+
+void ChunkCache::reset(SDL_Renderer* renderer, int chunkWidth, int chunkHeight, int apronX, int apronY)
+{
+	clear();
+
+	mRenderer = renderer;
+	mChunkWidth = chunkWidth;
+	mChunkHeight = chunkHeight;
+	mApronX = apronX;
+	mApronY = apronY;
+	mEnabled = renderer != NULL && SDL_RenderTargetSupported(renderer) == SDL_TRUE;
+}
+
+void ChunkCache::clear()
+{
+	for (std::list<Chunk>::iterator iter = mChunks.begin(); iter != mChunks.end(); iter++)
+		SDL_DestroyTexture(iter->texture);
+
+	mChunks.clear();
+	mIndex.clear();
+}
+
+Chunk* ChunkCache::acquire(const TileLayer* layer, int chunkX, int chunkY, bool &needsBake)
+{
+	ChunkKey key = { layer, chunkX, chunkY };
+
+	//cached chunks are moved to the front of the list
+	std::map<ChunkKey, std::list<Chunk>::iterator>::iterator found = mIndex.find(key);
+	if (found != mIndex.end())
+	{
+		mChunks.splice(mChunks.begin(), mChunks, found->second);
+		needsBake = false;
+		return &mChunks.front();
+	}
+
+	needsBake = true;
+	Chunk chunk = { layer, chunkX, chunkY, NULL, true };
+
+	if (static_cast<int>(mChunks.size()) >= mCapacity && !mChunks.empty())
+	{
+		//evicting the least recently used chunk, and reusing its texture
+		Chunk &oldest = mChunks.back();
+		ChunkKey oldKey = { oldest.layer, oldest.x, oldest.y };
+		chunk.texture = oldest.texture;
+		mIndex.erase(oldKey);
+		mChunks.pop_back();
+	}
+	else
+	{
+		chunk.texture = SDL_CreateTexture(mRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, mChunkWidth + mApronX, mChunkHeight + mApronY);
+		if (chunk.texture == NULL)
+			return NULL;
+		SDL_SetTextureBlendMode(chunk.texture, SDL_BLENDMODE_BLEND);
+	}
+
+	mChunks.push_front(chunk);
+	mIndex[key] = mChunks.begin();
+	return &mChunks.front();
+}
@@ -0,0 +1,96 @@
+#ifndef CHUNKCACHE_H
+#define CHUNKCACHE_H
+
+#include <list>
+#include <map>
+
+#if defined(_MSC_VER)
+#include <SDL.h>
+#elif defined(__clang__)
+#include <SDL2/SDL.h>
+#else
+#include <SDL2/SDL.h>
+#endif
+
+class TileLayer;
+
+//Width and height of a chunk, in tiles.
+const int CHUNK_TILES = 32;
+
+//Maximum number of chunk textures kept at once. At 16 pixel tiles each chunk is a 512x512 texture.
+const int MAX_CACHED_CHUNKS = 64;
+
+//A square block of CHUNK_TILES x CHUNK_TILES tiles of one layer, pre-rendered to a texture.
+struct Chunk
+{
+	const TileLayer* layer;
+	int x, y;					//position of the chunk in chunks, not tiles
+	SDL_Texture* texture;		//render target the chunk's tiles are baked into
+	bool empty;					//true if the chunk has no tiles, so drawing it can be skipped
+};
+
+//Least recently used cache of pre-rendered layer chunks.
+//Static layers are baked into chunk textures the first time they come into view, so that drawing a layer
+//only takes a handful of texture copies instead of one per tile. When the cache is full, the least recently
+//used chunk is evicted and its texture is reused for the new chunk, keeping memory bounded on large maps.
+class ChunkCache
+{
+public:
+	ChunkCache(int capacity = MAX_CACHED_CHUNKS);
+	~ChunkCache();
+
+	//Destroys all chunks and sets the renderer and the size of a chunk in pixels. Called when a level is opened.
+	//Chunk textures have an apron of apronX pixels on the right and apronY pixels on top, for tiles that are wider or taller
+	//than the map's tiles and reach past the edge of their chunk.
+	//The cache is disabled if the renderer does not support render targets.
+	void reset(SDL_Renderer* renderer, int chunkWidth, int chunkHeight, int apronX = 0, int apronY = 0);
+
+	//Destroys all chunks. Called when a level is closed, or when the renderer loses its render targets.
+	void clear();
+
+	//Returns the chunk at (chunkX, chunkY) of a layer, marking it as most recently used.
+	//If the chunk is not cached, a chunk with a blank texture is returned and needsBake is set,
+	//in which case the caller has to render the chunk's tiles into the texture.
+	//Returns NULL if no texture could be created.
+	Chunk* acquire(const TileLayer* layer, int chunkX, int chunkY, bool &needsBake);
+
+	bool isEnabled() const { return mEnabled; }
+	int getChunkWidth() const { return mChunkWidth; }
+	int getChunkHeight() const { return mChunkHeight; }
+	int getApronX() const { return mApronX; }
+	int getApronY() const { return mApronY; }
+
+	//Number of chunks cached, each with its own texture.
+	int getSize() const { return static_cast<int>(mChunks.size()); }
+
+	//Memory taken by the chunk textures, in bytes. Chunks are 32 bit render targets.
+	Uint64 getMemory() const { return static_cast<Uint64>(mChunks.size()) * (mChunkWidth + mApronX) * (mChunkHeight + mApronY) * sizeof(Uint32); }
+
+private:
+	struct ChunkKey
+	{
+		const TileLayer* layer;
+		int x, y;
+
+		bool operator< (const ChunkKey &other) const
+		{
+			if (layer != other.layer)
+				return layer < other.layer;
+			if (y != other.y)
+				return y < other.y;
+			return x < other.x;
+		}
+	};
+
+	//Chunks ordered from most recently used to least recently used.
+	std::list<Chunk> mChunks;
+	std::map<ChunkKey, std::list<Chunk>::iterator> mIndex;
+
+	SDL_Renderer* mRenderer;
+	int mCapacity;
+	int mChunkWidth, mChunkHeight;
+	int mApronX, mApronY;
+	bool mEnabled;
+};
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+#if defined(_MSC_VER)
+#include <SDL.h>
+#elif defined(__clang__)
+#include <SDL2/SDL.h>
+#else
+#include <SDL2/SDL.h>
+#endif
+
+//Counters the GameWorld collects while stats are enabled, summed since the last reset().
+//Times are in performance counter ticks, see Timer::Frequency().
+struct FrameStats
+{
+	FrameStats() { reset(); }
+
+	void reset()
+	{
+		ticks = 0;
+		logicTime = 0;
+		moveTime = 0;
+		collisionTime = 0;
+	}
+
+	//Number of simulation ticks run.
+	int ticks;
+
+	//Time spent in Actor::moveLogic().
+	Uint64 logicTime;
+
+	//Time spent moving Actors, including sweeping them in COLLISION_SWEPT mode.
+	Uint64 moveTime;
+
+	//Time spent correcting collisions after moving.
+	Uint64 collisionTime;
+};
+
+//Number of frames the FrameHistory keeps, five seconds at 60 frames per second.
+const int FRAME_HISTORY = 300;
+
+//What one rendered frame cost, filled in by the main loop. Times are in milliseconds.
+struct FrameSample
+{
+	//Time since the previous frame, frame cap included.
+	double frameTime;
+
+	//Time spent running simulation ticks, drawing the game states and flushing the sprite batch, and in SDL_RenderPresent().
+	//Presenting waits for the GPU when it falls behind, so GPU bound frames show up there.
+	double updateTime;
+	double drawTime;
+	double presentTime;
+
+	//Number of simulation ticks run.
+	int ticks;
+
+	//Renderer calls and sprites, see Window::getDrawCalls().
+	int drawCalls;
+	int sprites;
+
+	//Actors simulated, and drawn and culled by GameWorld::drawActors().
+	int actors;
+	int actorsDrawn;
+	int actorsCulled;
+};
+
+//The FrameSamples of the last FRAME_HISTORY frames, in a fixed ring so that adding one never allocates.
+class FrameHistory
+{
+public:
+	FrameHistory()
+		:mNext(0), mCount(0)
+	{
+	}
+
+	//Adds the sample of a frame, replacing the oldest one once the history is full.
+	void add(const FrameSample &sample)
+	{
+		mSamples[mNext] = sample;
+		mNext = (mNext + 1) % FRAME_HISTORY;
+		if (mCount < FRAME_HISTORY)
+			mCount++;
+	}
+
+	//Number of frames in the history.
+	int size() const { return mCount; }
+
+	//Returns the sample of a frame, from 0 for the oldest to size() - 1 for the latest.
+	const FrameSample& at(int index) const { return mSamples[(mNext - mCount + index + FRAME_HISTORY) % FRAME_HISTORY]; }
+
+private:
+	FrameSample mSamples[FRAME_HISTORY];
+	int mNext, mCount;
+};
+
+#endif
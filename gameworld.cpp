@@ -1,5 +1,11 @@
 #include "gameworld.h"
 #include "actor.h"
+#include "maploader.h"
+#include "profiler.h"
+#include "actorkernels.h"
+
+#include <cfloat>
+#include <cmath>
 
 const int X = 0;
 const int Y = 1;
@@ -10,6 +16,9 @@ const int INDEX_PLAYER = 0;
 //Slide variable should be moved to a private Actor variable.
 const int MIN_SLIDE = 10;
 
+//Level pixels around the camera view in which Actors are still drawn, so that nothing pops in at the edges of the screen.
+const int CULL_MARGIN = 32;
+
 //Compares Actors by their y position.
 //Used when ordering Actors in the orderedActors vector, so that Actors further down on screen are drawn first.
 //This allows actors behind other Actors to actually appear behind other actors.
@@ -86,10 +95,94 @@ bool detectOverlap(SDL_Rect *A, SDL_Rect *B, int *a = NULL, int *b = NULL, int *
 
 
 
+//Time of impact of a swept collision box, as a fraction of its movement, and the normal of the surface it hit.
+struct SweepHit
+{
+	float time;
+	int normalX, normalY;
+};
+
+//Number of times a sweep may hit something and slide along it in one move.
+//A box can only be stopped once on each axis, so a third sweep is never needed.
+const int MAX_SWEEPS = 2;
+
+//Boxes this many pixels into each other are treated as touching when sweeping,
+//so that rounding errors cannot sink a box into a wall far enough to be let through it.
+const float SWEEP_SKIN = 0.01f;
+
+//Finds when a box moving along one axis starts and stops overlapping a target along that axis, as fractions of the movement.
+//Returns false if they never overlap along the axis.
+bool sweepAxis(float pos, int size, float delta, int targetPos, int targetSize, float &entry, float &exit)
+{
+	if (delta == 0)
+	{
+		if (pos + size <= targetPos || pos >= targetPos + targetSize)
+			return false;
+
+		entry = -FLT_MAX;
+		exit = FLT_MAX;
+		return true;
+	}
+
+	//distances along the direction of movement
+	float entryDist, exitDist;
+	if (delta > 0)
+	{
+		entryDist = targetPos - (pos + size);
+		exitDist = targetPos + targetSize - pos;
+	}
+	else
+	{
+		entryDist = pos - (targetPos + targetSize);
+		exitDist = pos + size - targetPos;
+	}
+
+	if (entryDist < 0 && entryDist > -SWEEP_SKIN)
+		entryDist = 0;
+
+	float distance = delta > 0 ? delta : -delta;
+	entry = entryDist / distance;
+	exit = exitDist / distance;
+	return exit > 0;
+}
+
+//Sweeps a box at (x, y) by (dx, dy) against a static target box.
+//Records the hit if the box hits the target sooner than the hit found so far.
+//Boxes that already overlap are left to the discrete collision correction.
+void sweepBox(float x, float y, int w, int h, float dx, float dy, SDL_Rect *target, SweepHit &hit)
+{
+	float entryX, exitX, entryY, exitY;
+	if (!sweepAxis(x, w, dx, target->x, target->w, entryX, exitX) || !sweepAxis(y, h, dy, target->y, target->h, entryY, exitY))
+		return;
+
+	float entry = entryX > entryY ? entryX : entryY;
+	float exit = exitX < exitY ? exitX : exitY;
+	if (entry < 0 || entry > exit || entry >= hit.time)
+		return;
+
+	//the axis that started overlapping last is the one that was hit
+	hit.time = entry;
+	if (entryX > entryY)
+	{
+		hit.normalX = dx > 0 ? -1 : 1;
+		hit.normalY = 0;
+	}
+	else
+	{
+		hit.normalX = 0;
+		hit.normalY = dy > 0 ? -1 : 1;
+	}
+}
+
 GameWorld::GameWorld(Window* win)
-	:mPlayer(NULL), mDebugOn(false), mLevel(NULL), mWindow(win), mNextPlayerSpawn(0), 
-	mLoadNextLevel(false), mNextLevel("")
+	:mDebugOn(false), mOverlayOn(false), mPlayer(NULL), mLevel(NULL), mWindow(win), mNextPlayerSpawn(0), 
+	mLoadNextLevel(false), mNextLevel(""), mCharSprites(NULL), mInterpolation(1.f), mCollisionMode(COLLISION_SWEPT), mLevelLoader(win->getTextureCache()),
+	mStatsEnabled(false), mCharPage(NULL), mActorsDrawn(0), mActorsCulled(0)
 {
+	mCharOffset.x = 0;
+	mCharOffset.y = 0;
+	mAnimationClock.Start();
+
 	SDL_Rect boxSize;
 
 	boxSize.x = 10;
@@ -110,10 +203,22 @@ GameWorld::GameWorld(Window* win)
 	mPlayerSpawnPoint.w = 0;
 	mPlayerSpawnPoint.h = 0;
 
-	mDeltaTime.Start();
 }
 
 GameWorld::~GameWorld()
+{
+	//deleting all actors in world, and the level
+	closeLevel();
+
+	if (mCharSprites != NULL)
+		mWindow->ReleaseImage(mCharSprites->image);
+	delete mCharSprites;
+
+	//do not delete the window; this will be done seperately in the source code using SDL functions.
+
+}
+
+void GameWorld::closeLevel()
 {
 	//deleting all actors in world
 	for (std::vector<Actor*>::iterator iter = actorList.begin(); iter != actorList.end(); iter++)
@@ -121,14 +226,33 @@ GameWorld::~GameWorld()
 		delete *iter;
 	}
 	actorList.clear();
-
-	//deleting the level
+	orderedActorList.clear();
+	mVisibleActors.clear();
+	mPlayer = NULL;
+
+	//deleting the level, and the chunks and atlas pages rendered from it
+	mChunkCache.clear();
+	mAtlas.clear();
+	mCharPage = NULL;
+	if (mLevel != NULL)
+		releaseLevelImages(mLevel);
 	delete mLevel;
+	mLevel = NULL;
+}
 
-	delete mCharSprites;
-
-	//do not delete the window; this will be done seperately in the source code using SDL functions.
+void GameWorld::releaseLevelImages(Level* level)
+{
+	for (std::vector<Tileset*>::iterator iter = level->getTileSet()->begin(); iter != level->getTileSet()->end(); iter++)
+	{
+		mWindow->ReleaseImage((*iter)->image);
+		(*iter)->image = NULL;
+	}
 
+	for (std::vector<ParallaxLayer>::iterator iter = level->getParallaxLayers()->begin(); iter != level->getParallaxLayers()->end(); iter++)
+	{
+		mWindow->ReleaseImage(iter->image);
+		iter->image = NULL;
+	}
 }
 
 //takes in a rect of a collision box and returns a rect indicating which tiles in the level are being overlapped.
@@ -136,25 +260,24 @@ GameWorld::~GameWorld()
 //Used to detect collisions between Actors and background tiles.
 SDL_Rect GameWorld::tileRangeOverlap(SDL_Rect &collision)
 {
-	SDL_Rect overlap;
-	overlap.x = collision.x / mLevel->getTileWidth();
-	overlap.w = (collision.x + collision.w)/ mLevel->getTileWidth() + 1;
+	//first and last tile the box touches on each axis
+	int firstX = collision.x / mLevel->getTileWidth();
+	int lastX = (collision.x + collision.w) / mLevel->getTileWidth();
+	int firstY = collision.y / mLevel->getTileHeight();
+	int lastY = (collision.y + collision.h) / mLevel->getTileHeight();
 
 	//Checking if collision box goes over the edges of the level
-	if(overlap.x < 0)
-		overlap.x = 0;
+	firstX = std::max(firstX, 0);
+	firstY = std::max(firstY, 0);
+	lastX = std::min(lastX, mLevel->getWidth() - 1);
+	lastY = std::min(lastY, mLevel->getHeight() - 1);
 
-	if(overlap.w > mLevel->getWidth() - overlap.x)
-		overlap.w = mLevel->getWidth() - overlap.x;
-
-	overlap.y = collision.y / mLevel->getTileHeight();
-	overlap.h = (collision.y + collision.h) / mLevel->getTileHeight() + 1;
-
-	if(overlap.y < 0)
-		overlap.y = 0;
-
-	if (overlap.h > mLevel->getHeight() - overlap.y)
-		overlap.h = mLevel->getHeight() - overlap.y;
+	//w and h are the number of tiles, so that callers loop from x to x + w
+	SDL_Rect overlap;
+	overlap.x = firstX;
+	overlap.y = firstY;
+	overlap.w = std::max(lastX - firstX + 1, 0);
+	overlap.h = std::max(lastY - firstY + 1, 0);
 
 	return overlap;
 }
@@ -215,8 +338,11 @@ void GameWorld::correctOverlap(int A, int B, int C, int D, std::vector<Actor*>::
 }
 
 //BUG: OBJECT CAN TUNNEL BETWEEN TWO OBJECTS IF IT CAN ALMOST FIT INBETWEEN. NOT A MAJOR PROBLEM(?)
+//Tunnelling through walls on long frames is avoided by COLLISION_SWEPT mode, which sweeps Actors before this correction.
 void GameWorld::correctCollision(std::vector<Actor*>::iterator curActor)
 {
+	PROFILE_ZONE("correctCollision");
+
 	int A, B, C, D;		//four values representing edge differences. These will determine how far to move a rectangle back
 	//if it collides, in order to allow movement of rectangles right up to each other's edges.
 	//In addition, the smallest edge difference will provide the direction in which the rectangle was
@@ -227,11 +353,42 @@ void GameWorld::correctCollision(std::vector<Actor*>::iterator curActor)
 	//C = leftA - rightB
 	//D = rightA - leftB
 
-	//checking collision against other Actors
-	for(std::vector<Actor*>::iterator iter = actorList.begin(); iter != actorList.end(); iter++)
+	//checking collision against nearby Actors, found through the spatial hash
+	//The candidates are tested against the collision box in one batch first. Once a correction moves the box,
+	//the rest of the candidates are tested again one by one.
+	mSpatialHash.query(*(*curActor)->getCollisionBox(), mCollisionCandidates);
+	int numCandidates = static_cast<int>(mCollisionCandidates.size());
+	if (numCandidates > 0)
+	{
+		mCandidateX.resize(numCandidates);
+		mCandidateY.resize(numCandidates);
+		mCandidateW.resize(numCandidates);
+		mCandidateH.resize(numCandidates);
+		mCandidateHits.resize(numCandidates);
+		for (int i = 0; i < numCandidates; i++)
+		{
+			SDL_Rect* box = mCollisionCandidates[i]->getCollisionBox();
+			mCandidateX[i] = box->x;
+			mCandidateY[i] = box->y;
+			mCandidateW[i] = box->w;
+			mCandidateH[i] = box->h;
+		}
+		overlapBoxes(bestKernelPath(), *(*curActor)->getCollisionBox(), &mCandidateX[0], &mCandidateY[0], &mCandidateW[0], &mCandidateH[0],
+			numCandidates, &mCandidateHits[0]);
+	}
+
+	bool corrected = false;
+	for (int i = 0; i < numCandidates; i++)
 	{
-		if (iter != curActor && detectOverlap((*curActor)->getCollisionBox(), (*iter)->getCollisionBox(), &A, &B, &C, &D))
-			correctOverlap(A, B, C, D, curActor, (*iter)->getCollisionBox());
+		Actor* other = mCollisionCandidates[i];
+		if (other == *curActor || (!corrected && !mCandidateHits[i]))
+			continue;
+
+		if (detectOverlap((*curActor)->getCollisionBox(), other->getCollisionBox(), &A, &B, &C, &D))
+		{
+			correctOverlap(A, B, C, D, curActor, other->getCollisionBox());
+			corrected = true;
+		}
 	}
 
 	//NOTE: THIS CAN BE DONE FOR LARGER ENEMIES
@@ -251,15 +408,13 @@ void GameWorld::correctCollision(std::vector<Actor*>::iterator curActor)
 		if(mLevel->getWidth() <= x)
 			left = false;
 		else
-			left = mLevel->getSolidGid()->find(mLevel->getTileMap()[x][y]) != mLevel->getSolidGid()->end()
-			|| mLevel->getSolidGid()->find(mLevel->getTileMap2()[x][y]) != mLevel->getSolidGid()->end();
+			left = mLevel->isSolid(x, y);
 
 		//Checking for off map cases for right tile
 		if(mLevel->getWidth() <= x + 1)
 			right = false;
 		else
-			right = mLevel->getSolidGid()->find(mLevel->getTileMap()[x + 1][y]) != mLevel->getSolidGid()->end()
-			|| mLevel->getSolidGid()->find(mLevel->getTileMap2()[x + 1][y]) != mLevel->getSolidGid()->end();
+			right = mLevel->isSolid(x + 1, y);
 
 
 		both = left && right;
@@ -296,108 +451,382 @@ void GameWorld::correctCollision(std::vector<Actor*>::iterator curActor)
 	mPlayer->setCamera();
 }
 
+void GameWorld::sweepActor(std::vector<Actor*>::iterator curActor, float ticks)
+{
+	Actor* actor = *curActor;
+	actor->limitVelocity();
+
+	//the collision box is swept from the Actor's exact position rather than its rounded collision box
+	float x = actor->getPosx() + actor->getColx();
+	float y = actor->getPosy() + actor->getColy();
+	int w = actor->getCollisionBox()->w;
+	int h = actor->getCollisionBox()->h;
+	float dx = actor->getVelx() * ticks / 1000.f;
+	float dy = actor->getVely() * ticks / 1000.f;
+
+	int tileW = mLevel->getTileWidth();
+	int tileH = mLevel->getTileHeight();
+
+	for (int sweep = 0; sweep < MAX_SWEEPS && (dx != 0 || dy != 0); sweep++)
+	{
+		SweepHit hit = { 1.f, 0, 0 };
+
+		//the area covered by the whole movement
+		float left = dx < 0 ? x + dx : x;
+		float right = dx > 0 ? x + w + dx : x + w;
+		float top = dy < 0 ? y + dy : y;
+		float bottom = dy > 0 ? y + h + dy : y + h;
+
+		//solid tiles in the covered area, clamped to the level
+		int firstX = std::max(0, static_cast<int>(floorf(left / tileW)));
+		int lastX = std::min(mLevel->getWidth() - 1, static_cast<int>(floorf(right / tileW)));
+		int firstY = std::max(0, static_cast<int>(floorf(top / tileH)));
+		int lastY = std::min(mLevel->getHeight() - 1, static_cast<int>(floorf(bottom / tileH)));
+
+		for (int tileY = firstY; tileY <= lastY; tileY++)
+		{
+			for (int tileX = firstX; tileX <= lastX; tileX++)
+			{
+				if (!mLevel->isSolid(tileX, tileY))
+					continue;
+
+				SDL_Rect tile = { tileX * tileW, tileY * tileH, tileW, tileH };
+				sweepBox(x, y, w, h, dx, dy, &tile, hit);
+			}
+		}
+
+		//other Actors in the covered area, found through the spatial hash
+		SDL_Rect area = { static_cast<int>(floorf(left)), static_cast<int>(floorf(top)), 0, 0 };
+		area.w = static_cast<int>(ceilf(right)) - area.x;
+		area.h = static_cast<int>(ceilf(bottom)) - area.y;
+
+		mSpatialHash.query(area, mCollisionCandidates);
+		for (std::vector<Actor*>::iterator iter = mCollisionCandidates.begin(); iter != mCollisionCandidates.end(); iter++)
+		{
+			if (*iter != actor)
+				sweepBox(x, y, w, h, dx, dy, (*iter)->getCollisionBox(), hit);
+		}
+
+		x += dx * hit.time;
+		y += dy * hit.time;
+		if (hit.time >= 1.f)
+			break;
+
+		//the rest of the movement slides along the surface that was hit
+		dx = hit.normalX != 0 ? 0 : dx * (1.f - hit.time);
+		dy = hit.normalY != 0 ? 0 : dy * (1.f - hit.time);
+	}
+
+	actor->setPosition(x - actor->getColx(), y - actor->getColy());
+}
+
 void GameWorld::moveActors()
 {
-	//moves all actors, does collision correction
+	PROFILE_ZONE("moveActors");
+
+	//every call is one simulation tick
+	float ticks = SIMULATION_STEP;
+
+	//remembering where actors were, so that drawing can interpolate from there to where they end up
+	mActorStore.savePositions();
+
+	Uint64 start = mStatsEnabled ? SDL_GetPerformanceCounter() : 0;
+
+	//every actor decides where to go before any of them moves
 	for (std::vector<Actor*>::iterator iter = actorList.begin(); iter != actorList.end(); iter++)
-	{
 		(*iter)->moveLogic();
-		(*iter)->move(mDeltaTime.Ticks());
-		correctCollision(iter);
+
+	Uint64 logicDone = mStatsEnabled ? SDL_GetPerformanceCounter() : 0;
+	Uint64 moveTime = 0, collisionTime = 0;
+
+	if (mCollisionMode == COLLISION_SWEPT)
+	{
+		//each actor is swept against the others where they already moved to, so actors move one at a time
+		for (std::vector<Actor*>::iterator iter = actorList.begin(); iter != actorList.end(); iter++)
+		{
+			Uint64 moveStart = mStatsEnabled ? SDL_GetPerformanceCounter() : 0;
+			sweepActor(iter, ticks);
+			Uint64 moveDone = mStatsEnabled ? SDL_GetPerformanceCounter() : 0;
+
+			//this only corrects overlaps a sweep cannot prevent, such as Actors spawned inside each other
+			correctCollision(iter);
+
+			if (mStatsEnabled)
+			{
+				moveTime += moveDone - moveStart;
+				collisionTime += SDL_GetPerformanceCounter() - moveDone;
+			}
+		}
+	}
+	else
+	{
+		//moving every actor in one pass over the store, then correcting the collisions
+		mActorStore.integrate(ticks, VELOCITY);
+		for (std::vector<Actor*>::iterator iter = actorList.begin(); iter != actorList.end(); iter++)
+			mSpatialHash.update(*iter);
+
+		Uint64 moveDone = mStatsEnabled ? SDL_GetPerformanceCounter() : 0;
+
+		for (std::vector<Actor*>::iterator iter = actorList.begin(); iter != actorList.end(); iter++)
+			correctCollision(iter);
+
+		if (mStatsEnabled)
+		{
+			moveTime = moveDone - logicDone;
+			collisionTime = SDL_GetPerformanceCounter() - moveDone;
+		}
 	}
 
+	if (mStatsEnabled)
+	{
+		mStats.ticks++;
+		mStats.logicTime += logicDone - start;
+		mStats.moveTime += moveTime;
+		mStats.collisionTime += collisionTime;
+	}
 }
 
 
+void GameWorld::setInterpolation(float alpha)
+{
+	mInterpolation = alpha;
+	if (mPlayer != NULL)
+		mPlayer->setCamera();
+}
+
 void GameWorld::drawActors()
 {
+	PROFILE_ZONE("drawActors");
+
+	SDL_Rect view = mCamera.levelView();
+	view.x -= CULL_MARGIN;
+	view.y -= CULL_MARGIN;
+	view.w += 2 * CULL_MARGIN;
+	view.h += 2 * CULL_MARGIN;
+
+	double now = getAnimationTime();
+
+	//Culling first, so that only the Actors in view are sorted. The others only keep their animation going.
+	mVisibleActors.clear();
+	mVisibleSlots.clear();
+	for (size_t i = 0; i < orderedActorList.size(); i++)
+	{
+		SDL_Rect bounds = orderedActorList[i]->getDrawBounds();
+		if (SDL_HasIntersection(&bounds, &view))
+		{
+			mVisibleActors.push_back(orderedActorList[i]);
+			mVisibleSlots.push_back(i);
+		}
+		else
+			orderedActorList[i]->advanceAnimation(now);
+	}
+
 	//Making sure to draw Actors in correct order, from lowest on screen to highest.
-	orderedActorList = actorList;
-	std::sort(orderedActorList.begin(), orderedActorList.end(), compareByPosY);
+	//The order is kept between frames, and Actors only move a few pixels per frame, so an insertion sort
+	//only has to swap the few Actors that passed each other since the last frame.
+	for (size_t i = 1; i < mVisibleActors.size(); i++)
+	{
+		Actor* actor = mVisibleActors[i];
+		size_t j = i;
+		while (j > 0 && compareByPosY(actor, mVisibleActors[j - 1]))
+		{
+			mVisibleActors[j] = mVisibleActors[j - 1];
+			j--;
+		}
+		mVisibleActors[j] = actor;
+	}
+
+	//The sorted Actors go back into the slots they were taken from, so that their order is kept for the next frame.
+	for (size_t i = 0; i < mVisibleActors.size(); i++)
+		orderedActorList[mVisibleSlots[i]] = mVisibleActors[i];
 
-	//draw all actors to screen
-	for (std::vector<Actor*>::iterator iter = orderedActorList.begin(); iter != orderedActorList.end(); iter++)
+	for (std::vector<Actor*>::iterator iter = mVisibleActors.begin(); iter != mVisibleActors.end(); iter++)
 	{
-		(*iter)->animate();
+		(*iter)->animate(now);
 		(*iter)->draw(*mWindow);
 		if (mDebugOn)
 			(*iter)->drawRect(*mWindow);
 	}
+
+	mActorsDrawn = static_cast<int>(mVisibleActors.size());
+	mActorsCulled = static_cast<int>(orderedActorList.size() - mVisibleActors.size());
+
+	PROFILE_COUNTER("actors drawn", mActorsDrawn);
+	PROFILE_COUNTER("actors culled", mActorsCulled);
+}
+
+bool GameWorld::getTileClip(int gid, SDL_Texture** image, SDL_Rect* clip)
+{
+	//The Tileset and clip of every gid are precomputed when the map is opened.
+	const GidEntry* entry = mLevel->getGidEntry(gid);
+	if (entry == NULL)
+		return false;
+
+	Tileset* tileset = (*mLevel->getTileSet())[entry->tileset];
+	*image = tileset->page != NULL ? tileset->page : tileset->image;
+	*clip = entry->clip;
+	return true;
+}
+
+void GameWorld::bakeChunk(Chunk* chunk)
+{
+	SDL_Renderer* renderer = mWindow->getRenderer();
+
+	//Queued quads are drawn to the screen before the target changes. They may also use the texture of an evicted chunk.
+	mWindow->FlushBatch();
+
+	//Saving the render target and draw color, as the chunk is cleared to transparent.
+	SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+	Uint8 r, g, b, a;
+	SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+
+	SDL_SetRenderTarget(renderer, chunk->texture);
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+	SDL_RenderClear(renderer);
+
+	//Tiles are drawn unscaled; the chunk is scaled by SIZE_FACTOR when it is drawn to the screen.
+	//The chunk's tiles start below the apron, which holds the parts of tall tiles in its top row that reach above it.
+	int firstX = chunk->x * CHUNK_TILES;
+	int firstY = chunk->y * CHUNK_TILES;
+	int apronY = mChunkCache.getApronY();
+	chunk->empty = true;
+
+	for (int y = firstY; y < firstY + CHUNK_TILES && y < mLevel->getHeight(); y++)
+	{
+		const int* tileRow = chunk->layer->row(y);
+		for (int x = firstX; x < firstX + CHUNK_TILES && x < mLevel->getWidth(); x++)
+		{
+			SDL_Texture* image;
+			SDL_Rect tileClip;
+			if (!getTileClip(tileRow[x], &image, &tileClip))
+				continue;
+
+			//Tiles from tilesets with taller tiles are aligned to the bottom of the map tile, as in Tiled.
+			SDL_Rect tileLocation = { (x - firstX) * mLevel->getTileWidth(), apronY + (y + 1 - firstY) * mLevel->getTileHeight() - tileClip.h, tileClip.w, tileClip.h };
+			SDL_RenderCopy(renderer, image, &tileClip, &tileLocation);
+			chunk->empty = false;
+		}
+	}
+
+	SDL_SetRenderTarget(renderer, previousTarget);
+	SDL_SetRenderDrawColor(renderer, r, g, b, a);
 }
 
-void GameWorld::drawBackground(int** tilemap)
+void GameWorld::drawBackground(TileLayer* tilemap)
 {
 	if(mLevel == NULL)
 		return;
 	if(tilemap == NULL)
 		return;
 
-	//assuming first tileset is background tiles.
-
-	//Drawing only the tiles in view of the camera.
-	SDL_Rect visibleTiles = tileRangeOverlap(mCamera.view);
-
-	std::set<Tileset*>::iterator selectedTileset = mLevel->getTileSet()->begin();
+	if (!mChunkCache.isEnabled())
+	{
+		drawTiles(tilemap);
+		return;
+	}
 
-	//For each visible tile...
-	for(int y = visibleTiles.y; y <= visibleTiles.y + visibleTiles.h && y < mLevel->getHeight(); y++)
+	//Drawing only the chunks in view of the camera, including those left of and below it whose apron reaches into view.
+	//The camera view is in screen pixels, which are scaled up by SIZE_FACTOR from level pixels.
+	int chunkWidth = mChunkCache.getChunkWidth();
+	int chunkHeight = mChunkCache.getChunkHeight();
+	int apronX = mChunkCache.getApronX();
+	int apronY = mChunkCache.getApronY();
+	int firstChunkX = std::max(mCamera.view.x - apronX, 0) / chunkWidth;
+	int firstChunkY = std::max(mCamera.view.y, 0) / chunkHeight;
+	int lastChunkX = std::min(mCamera.view.x + mCamera.view.w / SIZE_FACTOR, mLevel->getWidth() * mLevel->getTileWidth() - 1) / chunkWidth;
+	int lastChunkY = std::min(mCamera.view.y + mCamera.view.h / SIZE_FACTOR + apronY, mLevel->getHeight() * mLevel->getTileHeight() - 1) / chunkHeight;
+
+	for (int y = firstChunkY; y <= lastChunkY; y++)
 	{
-		for(int x = visibleTiles.x; x <= visibleTiles.x + visibleTiles.w && x < mLevel->getWidth(); x++)
+		for (int x = firstChunkX; x <= lastChunkX; x++)
 		{
-			//Get the relative tile ID by the subtracting the first global id of the Tileset.
-			int tileGidRelative = tilemap[x][y] - (*selectedTileset)->firstGid;
+			bool needsBake;
+			Chunk* chunk = mChunkCache.acquire(tilemap, x, y, needsBake);
+			if (chunk == NULL)
+				continue;
 
-			//Finding the width of the tileset source image in tiles.
-			int numTilesX = (*selectedTileset)->w / (*selectedTileset)->tileW;
+			if (needsBake)
+				bakeChunk(chunk);
 
-			//Finding the index of the particular tile.
-			int tileIndexX = tileGidRelative % numTilesX;
-			int tileIndexY = tileGidRelative / numTilesX;
+			//Drawing the chunk relative to the camera, with its apron over the chunks above and to the right.
+			//Chunks are drawn top to bottom, so tall tiles cover the row above them as they do in drawTiles().
+			if (!chunk->empty)
+			{
+				SDL_Rect chunkClip = { 0, 0, chunkWidth + apronX, chunkHeight + apronY };
+				mWindow->DrawBatched(chunk->texture, x * chunkWidth - mCamera.view.x, y * chunkHeight - apronY - mCamera.view.y, &chunkClip);
+			}
+		}
+	}
+}
 
-			//Creating the clip of the tileset source image from the previous data.
-			SDL_Rect tileClip = { tileIndexX  * mLevel->getTileWidth(), tileIndexY * mLevel->getTileHeight(), (*selectedTileset)->tileW, (*selectedTileset)->tileH };
+void GameWorld::drawTiles(TileLayer* tilemap)
+{
+	//Drawing only the tiles in view of the camera.
+	SDL_Rect view = mCamera.levelView();
+	//the range is clamped to the level, and its w and h are tile counts
+	SDL_Rect visibleTiles = tileRangeOverlap(view);
+
+	//Tiles of tilesets with larger tiles reach up and right from the map tile they are on, so the tiles left of and
+	//below the view are drawn too, as far as the chunk apron, rounded up to whole tiles.
+	int apronTilesX = (mChunkCache.getApronX() + mLevel->getTileWidth() - 1) / mLevel->getTileWidth();
+	int apronTilesY = (mChunkCache.getApronY() + mLevel->getTileHeight() - 1) / mLevel->getTileHeight();
+	int firstX = std::max(visibleTiles.x - apronTilesX, 0);
+	visibleTiles.w += visibleTiles.x - firstX;
+	visibleTiles.x = firstX;
+	visibleTiles.h = std::min(visibleTiles.h + apronTilesY, mLevel->getHeight() - visibleTiles.y);
+
+	//For each visible tile...
+	for(int y = visibleTiles.y; y < visibleTiles.y + visibleTiles.h; y++)
+	{
+		const int* tileRow = tilemap->row(y);
+		for(int x = visibleTiles.x; x < visibleTiles.x + visibleTiles.w; x++)
+		{
+			SDL_Texture* image;
+			SDL_Rect tileClip;
+			if (!getTileClip(tileRow[x], &image, &tileClip))
+				continue;
 
 			int tileLocationX = x * mLevel->getTileWidth();
-			int tileLocationY = y * mLevel->getTileHeight();
+			int tileLocationY = (y + 1) * mLevel->getTileHeight() - tileClip.h;
 
 			//Drawing the tile relative to the camera.
-			mWindow->Draw((*selectedTileset)->image, tileLocationX - mCamera.view.x, tileLocationY - mCamera.view.y, &tileClip);
+			mWindow->DrawBatched(image, tileLocationX - mCamera.view.x, tileLocationY - mCamera.view.y, &tileClip);
 		}
 	}
 }
 
 void GameWorld::parallaxBg()
 {
-	if(getLevel()->getParallax() == NULL)
-		return;
-
-	float x, y;
-
-	if (mCamera.view.y < 0)
-		y = 0.5 * mCamera.view.y;
-	else
-		y = -0.5 * mCamera.view.y;
-
-	if(mCamera.view.x < 0)
-		x = 0.5 * mCamera.view.x;
-	else
-		x = -0.5 * mCamera.view.x;
-
+	PROFILE_ZONE("parallaxBg");
 
-	float pw = (mLevel->getTileWidth() * mLevel->getWidth() - mCamera.view.w) / 0.5 + mCamera.view.w;
-	float ph = (mLevel->getTileHeight() * mLevel->getHeight() - mCamera.view.h) / 0.5 + mCamera.view.h;
+	if (mLevel == NULL)
+		return;
 
-	int w, h;
-	SDL_QueryTexture(getLevel()->getParallax(), NULL, NULL, &w, &h);
-	
-	float blitX = pw / w + 2;
-	float blitY = ph / h + 2;
-	
+	//the screen, in level pixels
+	int screenW = mCamera.view.w / SIZE_FACTOR;
+	int screenH = mCamera.view.h / SIZE_FACTOR;
 
-	for(int n = 0; n < blitY; n++)
+	//Each layer is repeated across the screen only, starting from the copy under its top left corner.
+	//All copies of a layer are drawn with the same texture, so the sprite batch draws each layer at once.
+	std::vector<ParallaxLayer>* layers = mLevel->getParallaxLayers();
+	for (std::vector<ParallaxLayer>::iterator layer = layers->begin(); layer != layers->end(); layer++)
 	{
-		for(int m = 0; m < blitX; m++)
-			mWindow->Draw(getLevel()->getParallax(), x + m * w, y + n * h);
+		if (layer->image == NULL || layer->w <= 0 || layer->h <= 0)
+			continue;
+
+		//position of a copy of the image relative to the screen, wrapped to the copy just left of and above it
+		int offsetX = static_cast<int>(floor(-layer->factorX * mCamera.view.x)) % layer->w;
+		int offsetY = static_cast<int>(floor(-layer->factorY * mCamera.view.y)) % layer->h;
+		if (offsetX > 0)
+			offsetX -= layer->w;
+		if (offsetY > 0)
+			offsetY -= layer->h;
+
+		for (int y = offsetY; y < screenH; y += layer->h)
+		{
+			for (int x = offsetX; x < screenW; x += layer->w)
+				mWindow->DrawBatched(layer->image, x, y);
+		}
 	}
 }
 
@@ -406,14 +835,18 @@ void GameWorld::spawnPlayer(SDL_Texture* sprite, SDL_Rect* clip, SDL_Rect* colBo
 	//spawns a new player
 	Player *newPlayer = new Player(this, sprite, x, y, clip, colBox, colBoxX, colBoxY);
 	actorList.push_back(newPlayer);
+	orderedActorList.push_back(newPlayer);
+	mSpatialHash.insert(newPlayer);
 	mPlayer = newPlayer;
 }
 
-void GameWorld::spawnActor(SDL_Texture* sprite, int x, int y, SDL_Rect* collisionBox)
+void GameWorld::spawnActor(SDL_Texture* sprite, int x, int y, SDL_Rect* collisionBox, SDL_Rect* clip)
 {
 	//spawns a new actor
-	Actor *newActor = new Actor(this, sprite, x, y, NULL, collisionBox, 0, 50);
+	Actor *newActor = new Actor(this, sprite, x, y, clip, collisionBox, 0, 50);
 	actorList.push_back(newActor);
+	orderedActorList.push_back(newActor);
+	mSpatialHash.insert(newActor);
 }
 
 void GameWorld::toggleColBox()
@@ -421,252 +854,211 @@ void GameWorld::toggleColBox()
 	mDebugOn = !mDebugOn;
 }
 
+Uint64 GameWorld::getTextureMemory()
+{
+	return mWindow->getTextureCache()->getMemory() + mWindow->getGlyphCache()->getMemory()
+		+ mAtlas.getMemory() + mChunkCache.getMemory();
+}
+
 SDL_Rect GameWorld::getCharClip(int index)
 {
 	int charIndexX = index % (mCharSprites->w / mCharSprites->tileW);
 	int charIndexY = index / (mCharSprites->w / mCharSprites->tileW);
-	SDL_Rect clip = { charIndexX * mCharSprites->tileW, charIndexY * mCharSprites->tileH, mCharSprites->tileW, mCharSprites->tileH };
+	SDL_Rect clip = { mCharOffset.x + charIndexX * mCharSprites->tileW, mCharOffset.y + charIndexY * mCharSprites->tileH, mCharSprites->tileW, mCharSprites->tileH };
 	return clip;
 }
 
-void GameWorld::openMap(std::string title)
+void GameWorld::buildAtlas()
 {
-	//------------------------------------------FORMAT---------------------------------------------------------------//
-	//- tiles that are solid will have property name = "solid" and either value "0" or "1" indicating soldness.
-	//- one image per tileset.
-	//- first tileset is the background tileset.
-	//- an object layer "playerSpawn" with a rectangle indicating spawn location.
-	//- to make player not go off edges of map, add invisible solid tiles around border.
-	//- For parallax background: In map properties, add the property "parallaxBg" and the image file name as its value.
-
-	//Layer format:
-
-	//over layer 2
-	//over layer, with non-solid tiles indicating things above actors
-	//actor layer
-	//background layer 2, with solid/passable tiles for objects with transparency
-	//background layer 1, with solid/passable tiles
-
-	//Character sprite sheets are stored in a single image opened by openCharTiles().
-	//		  step1    stand    step2
-	//down
-	//left
-	//right
-	//up
-	//topleft
-	//botleft
-	//topright
-	//botright
-
-	//Look at the Tiled website to see the format of the TMX XML tree.
-	//-------------------------------------------------------------------------------------------------------------------//
-
-
-	//reads in file, converts to string, and passes it to a xml_document object
-	//this object parses the document and converts it to a DOM tree
-
-	std::ifstream mapFile(title);
-	std::ostringstream temp;
-	std::string map;
-
-	temp << mapFile.rdbuf();
-	map = temp.str();
-	
-	rapidxml::xml_document<> mapData;
-	mapData.parse<0>(&map[0]);
-
-	//reads the first child of the xml root node, which is the map node
-	//obtains map/tile dimensions and dynamically creates a tilemap array of tile IDs
-	rapidxml::xml_node<> *mapProperties = mapData.first_node();
-	int levelWidth = atoi(mapProperties->first_attribute("width")->value());
-	int levelHeight = atoi(mapProperties->first_attribute("height")->value());
-	int tileWidth = atoi(mapProperties->first_attribute("tilewidth")->value());
-	int tileHeight = atoi(mapProperties->first_attribute("tileheight")->value());
+	std::vector<Tileset*>* tilesets = mLevel->getTileSet();
 
+	std::vector<SDL_Texture*> images;
+	for (std::vector<Tileset*>::iterator iter = tilesets->begin(); iter != tilesets->end(); iter++)
+		images.push_back((*iter)->image);
+	if (mCharSprites != NULL)
+		images.push_back(mCharSprites->image);
 
-	//Opening parallax image
-	rapidxml::xml_node<> *mapPropertiesExtra = mapProperties->first_node("properties");
-	if(mapPropertiesExtra != NULL)
-		mapPropertiesExtra = mapPropertiesExtra->first_node("property");
+	mAtlas.build(mWindow->getRenderer(), images);
 
-	std::string parallaxSource;
-	SDL_Texture* parallaxBg = NULL;
-	rapidxml::xml_attribute<> *parallaxAttr = NULL;
-	std::string parallaxProperty;
+	//moving the clips of every packed Tileset into its page
+	std::vector<SDL_Point> offsets(tilesets->size());
+	for (size_t i = 0; i < tilesets->size(); i++)
+	{
+		Tileset* tileset = (*tilesets)[i];
+		if (!mAtlas.find(tileset->image, &tileset->page, &offsets[i]))
+			tileset->page = NULL;
+	}
 
-	if(mapPropertiesExtra != NULL)
-		parallaxProperty = mapPropertiesExtra->first_attribute("name")->value();
-	if(parallaxProperty == "parallaxBg")
-		parallaxSource = mapPropertiesExtra->first_attribute("value")->value();
+	std::vector<GidEntry>* gidTable = mLevel->getGidTable();
+	for (std::vector<GidEntry>::iterator iter = gidTable->begin(); iter != gidTable->end(); iter++)
+	{
+		if (iter->tileset < 0 || (*tilesets)[iter->tileset]->page == NULL)
+			continue;
 
-	if(parallaxSource != "")
-		parallaxBg = mWindow->LoadImage(parallaxSource);
+		iter->clip.x += offsets[iter->tileset].x;
+		iter->clip.y += offsets[iter->tileset].y;
+	}
 
-	mLevel = new Level(levelWidth, levelHeight, tileWidth, tileHeight, parallaxBg);
+	mCharPage = NULL;
+	mCharOffset.x = 0;
+	mCharOffset.y = 0;
+	if (mCharSprites != NULL)
+		mAtlas.find(mCharSprites->image, &mCharPage, &mCharOffset);
+}
 
+void GameWorld::openMap(std::string title)
+{
+	//the map format is described in maploader.cpp
+	//a map that was preloaded is taken from the level loader, otherwise it is loaded here
+	//the previous level, if there is one, is closed once the new one is installed
+	installLevel(mLevelLoader.wait(title));
+}
 
-	//Going through the DOM tree
-	for (rapidxml::xml_node<> *mapInfo = mapProperties->first_node(); mapInfo != NULL; mapInfo = mapInfo->next_sibling())
+void GameWorld::installLevel(Level* level)
+{
+	//Loading the new level's images through the texture cache before the previous level releases its own,
+	//so images both levels use are neither destroyed nor loaded again.
+	//Images the level loader decoded are only uploaded if they are not cached.
+	try
 	{
-		std::string nodeName = mapInfo->name();
-
-		//tilesets
-		if (nodeName == "tileset")
+		for (std::vector<Tileset*>::iterator iter = level->getTileSet()->begin(); iter != level->getTileSet()->end(); iter++)
 		{
-			printf("Here is a tileset.\n");
-
-			//loads tileset image from tileset node's child, image node
-			//contains source location of image
-			//loads image to a SDL_Texture;
+			SDL_Surface* pixels = (*iter)->pixels;
+			(*iter)->pixels = NULL;
 
-			rapidxml::xml_node<> *image = mapInfo->first_node("image");
-			SDL_Texture* tilesetImage = mWindow->LoadImage(image->first_attribute("source")->value());
-			if (tilesetImage == NULL)
-				throw std::runtime_error("Failed to load image\n");
-
-			//Obtains the first global ID.
-			//Remember that width and height correspond to the number of tiles, not pixels.
-			int fgid = atoi(mapInfo->first_attribute("firstgid")->value());
-			int width = atoi(image->first_attribute("width")->value());
-			int height = atoi(image->first_attribute("height")->value());
-			int tileWidth = atoi(mapInfo->first_attribute("tilewidth")->value());
-			int tileHeight = atoi(mapInfo->first_attribute("tileheight")->value());
-			int alpha = atoi(image->first_attribute("trans")->value());
-
-			Tileset* newTileset = new Tileset(tilesetImage, fgid, width, height, tileWidth, tileHeight, alpha);
-
-			//pushes texture pointer onto tileset vector in mLevel
-			mLevel->getTileSet()->insert(newTileset);
-
-			//Searches the tile properties to find which tiles are solid.
-			for (rapidxml::xml_node<> *tile = mapInfo->first_node("tile"); tile != NULL; tile = tile->next_sibling("tile"))
-			{
-
-				std::string solidness = tile->first_node("properties")->first_node("property")->first_attribute("name")->value();
-				bool solidProperty = solidness == "solid";
-				bool isSolid = atoi(tile->first_node("properties")->first_node("property")->first_attribute("value")->value());
-
-				//Remember to add the first global id to the relative Tile id.
-				if (solidProperty && isSolid)
-					mLevel->getSolidGid()->insert(atoi(tile->first_attribute("id")->value()) + fgid);
-			}
+			if (pixels != NULL)
+				(*iter)->image = mWindow->LoadImage((*iter)->source, pixels);
+			else
+				(*iter)->image = mWindow->LoadImage((*iter)->source);
 		}
 
-
-		//layers
-		else if (nodeName == "layer")
+		//Opening parallax images
+		for (std::vector<ParallaxLayer>::iterator iter = level->getParallaxLayers()->begin(); iter != level->getParallaxLayers()->end(); iter++)
 		{
-			printf("Here is a layer.\n");
+			SDL_Surface* pixels = iter->pixels;
+			iter->pixels = NULL;
+
+			if (pixels != NULL)
+				iter->image = mWindow->LoadImage(iter->source, pixels);
+			else
+				iter->image = mWindow->LoadImage(iter->source);
+			SDL_QueryTexture(iter->image, NULL, NULL, &iter->w, &iter->h);
+		}
+	}
+	catch (...)
+	{
+		releaseLevelImages(level);
+		delete level;
+		throw;
+	}
 
-			//gets base64 encoded data and removes whitespaces from data
-			std::string encodedData = mapInfo->first_node()->value();
-			encodedData.erase(std::remove_if(encodedData.begin(), encodedData.end(), isspace), encodedData.end());
+	if (mLevel != NULL)
+		closeLevel();
 
-			//decodes data
-			std::string tileMapData = base64_decode(encodedData);
+	mLevel = level;
+	buildAtlas();
 
-			//erases null terminating character
-			tileMapData.erase(tileMapData.end() - 1, tileMapData.end());
+	//layers are pre-rendered in chunks of CHUNK_TILES x CHUNK_TILES tiles, with room for the tiles of tilesets
+	//with larger tiles, which reach up and right past the map tile they are on
+	int apronX = 0, apronY = 0;
+	for (std::vector<Tileset*>::iterator iter = mLevel->getTileSet()->begin(); iter != mLevel->getTileSet()->end(); iter++)
+	{
+		apronX = std::max(apronX, (*iter)->tileW - mLevel->getTileWidth());
+		apronY = std::max(apronY, (*iter)->tileH - mLevel->getTileHeight());
+	}
+	mChunkCache.reset(mWindow->getRenderer(), CHUNK_TILES * mLevel->getTileWidth(), CHUNK_TILES * mLevel->getTileHeight(), apronX, apronY);
 
-			//union to convert decoded chars to tile id ints
-			union codeData
-			{
-				int i;
-				char c[4];
-			} gid;
-
-			//converting data into global Ids for tiles (gid)
-			//decoded data is little endian byte order
-			//tiles are read in row by row to mLevel tilemap array
-			for (int tileNum = 0; tileNum < mLevel->getWidth() * mLevel->getHeight(); tileNum++)
-			{
-				gid.c[3] = tileMapData[4 * tileNum + 3];
-				gid.c[2] = tileMapData[4 * tileNum + 2];
-				gid.c[1] = tileMapData[4 * tileNum + 1];
-				gid.c[0] = tileMapData[4 * tileNum];
-
-				int heightIndex = tileNum / mLevel->getWidth();
-				int widthIndex = tileNum % mLevel->getWidth();
-
-				std::string layerName = mapInfo->first_attribute("name")->value();
-				if (layerName == "background")
-					mLevel->getTileMap()[widthIndex][heightIndex] = gid.i;
-				else if (layerName == "background2")
-					mLevel->getTileMap2()[widthIndex][heightIndex] = gid.i;
-				else if (layerName == "overlayer")
-					mLevel->getOverMap()[widthIndex][heightIndex] = gid.i;
-				else if (layerName == "overlayer2")
-					mLevel->getOverMap2()[widthIndex][heightIndex] = gid.i;
-			}
-		}
+	//the spatial hash uses the level's tiles as its cells
+	mSpatialHash.reset(mLevel->getTileWidth(), mLevel->getTileHeight());
 
+	//spawning the player at the chosen object of the playerSpawn group, or the first one if there are not that many
+	MapObject* playerSpawn = mLevel->findObject("playerSpawn", mNextPlayerSpawn);
+	if (playerSpawn == NULL)
+		playerSpawn = mLevel->findObject("playerSpawn");
 
-		//object groups
-		else if (nodeName == "objectgroup")
-		{
-			printf("Here is a object group.\n");
-			std::string objectGroupName = mapInfo->first_attribute("name")->value();
-			if (objectGroupName == "playerSpawn")
-			{
-				rapidxml::xml_node<> *playerSpawn = mapInfo->first_node("object");
-				for (int n = 0; n < mNextPlayerSpawn; n++)
-				{
-					playerSpawn->next_sibling("object");
-				}
+	if (playerSpawn != NULL)
+	{
+		mPlayerSpawnPoint.x = playerSpawn->box.x;
+		mPlayerSpawnPoint.y = playerSpawn->box.y;
 
-				mPlayerSpawnPoint.x = atoi(playerSpawn->first_attribute("x")->value());
-				mPlayerSpawnPoint.y = atoi(playerSpawn->first_attribute("y")->value());
+		/*
+		NOTE: THIS SPAWN DATA IS SPECIFIC TO THE TEST SPRITE!!!!!!!!!!!!!
+		NOTE: THIS SPAWN DATA IS SPECIFIC TO THE TEST SPRITE!!!!!!!!!!!!!
+		NOTE: THIS SPAWN DATA IS SPECIFIC TO THE TEST SPRITE!!!!!!!!!!!!!
+		*/
 
+		SDL_Rect colBoxDude = { 0, 27, 26, 26 };
 
+		spawnPlayer(getCharImage(), &getCharClip(INDEX_PLAYER), &colBoxDude, 0, 27, mPlayerSpawnPoint.x, mPlayerSpawnPoint.y);
+	}
+}
 
-				/*
-				NOTE: THIS SPAWN DATA IS SPECIFIC TO THE TEST SPRITE!!!!!!!!!!!!!
-				NOTE: THIS SPAWN DATA IS SPECIFIC TO THE TEST SPRITE!!!!!!!!!!!!!
-				NOTE: THIS SPAWN DATA IS SPECIFIC TO THE TEST SPRITE!!!!!!!!!!!!!
-				NOTE: THIS SPAWN DATA IS SPECIFIC TO THE TEST SPRITE!!!!!!!!!!!!!
-				NOTE: THIS SPAWN DATA IS SPECIFIC TO THE TEST SPRITE!!!!!!!!!!!!!
-				NOTE: THIS SPAWN DATA IS SPECIFIC TO THE TEST SPRITE!!!!!!!!!!!!!
-				NOTE: THIS SPAWN DATA IS SPECIFIC TO THE TEST SPRITE!!!!!!!!!!!!!
-				*/
+bool GameWorld::updateLevelLoad()
+{
+	if (!mLoadNextLevel)
+		return false;
 
+	//does nothing if the level is already loading, or was preloaded
+	mLevelLoader.request(mNextLevel);
 
-				SDL_Rect colBoxDude = { 0, 27, 26, 26 };
+	//a map that cannot be loaded or uploaded leaves the current level running, and its exit is ignored until the player leaves it
+	try
+	{
+		Level* level = mLevelLoader.take(mNextLevel);
+		if (level == NULL)
+			return false;
 
+		mLoadNextLevel = false;
+		installLevel(level);
+	}
+	catch (const std::runtime_error &e)
+	{
+		printf("%s\n", e.what());
+		mLoadNextLevel = false;
+		mFailedLevel = mNextLevel;
+		return false;
+	}
+	return true;
+}
 
-				spawnPlayer(mCharSprites->image, &getCharClip(INDEX_PLAYER), &colBoxDude, 0, 27, mPlayerSpawnPoint.x, mPlayerSpawnPoint.y);
-			}
+void GameWorld::checkExits()
+{
+	if (mPlayer == NULL || mLevel == NULL || mLoadNextLevel)
+		return;
 
-			if (objectGroupName == "playerExit")
-			{
-			}
-		}
+	//playerExit objects have the properties "map", the file name of the destination map,
+	//and "spawn", the index of the playerSpawn object to spawn at in the destination map
+	SDL_Rect* player = mPlayer->getCollisionBox();
+	std::vector<MapObject>* objects = mLevel->getObjects();
+	bool inFailedExit = false;
+	for (std::vector<MapObject>::iterator iter = objects->begin(); iter != objects->end(); iter++)
+	{
+		std::string map = findProperty(iter->properties, "map");
+		if (iter->group != "playerExit" || map == "")
+			continue;
 
-		//image layers
-		else if (nodeName == "imagelayer")
+		//not retrying a map that failed to load every tick while the player stands in its exit
+		if (map == mFailedLevel && SDL_HasIntersection(player, &iter->box))
 		{
-			printf("Here is an image layer.\n");
+			inFailedExit = true;
+			continue;
 		}
 
-		//properties
-		else if (nodeName == "properties")
-		{
-			printf("Here is a properties layer.\n");
-			/*
-			for (rapidxml::xml_node<> *properties = mapInfo->first_node(); properties != NULL; properties = properties->next_sibling())
-			{
-				std::string propertyName = properties->first_attribute("name")->value();
-				std::string propertyValue = properties->first_attribute("value")->value();
+		SDL_Rect nearby = { iter->box.x - EXIT_PRELOAD_DISTANCE, iter->box.y - EXIT_PRELOAD_DISTANCE,
+			iter->box.w + 2 * EXIT_PRELOAD_DISTANCE, iter->box.h + 2 * EXIT_PRELOAD_DISTANCE };
 
-				if (propertyName == "parallaxBg" && propertyValue != "")
-					parallaxBg = mWindow->LoadImage(propertyValue);
-			}*/
+		if (SDL_HasIntersection(player, &iter->box))
+		{
+			mNextLevel = map;
+			mNextPlayerSpawn = atoi(findProperty(iter->properties, "spawn").c_str());
+			mLoadNextLevel = true;
+			return;
 		}
 
-		else
-			;
+		if (SDL_HasIntersection(player, &nearby))
+			preloadMap(map);
 	}
 
-
-	mapFile.close();
-	mapData.clear();
-}
\ No newline at end of file
+	if (!inFailedExit)
+		mFailedLevel = "";
+}
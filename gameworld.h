@@ -6,12 +6,23 @@
 #include <set>
 #include <fstream>
 #include <sstream>
+#include <cstdio>
 #include <algorithm>
+#include <cstring>
+#include <stdint.h>
 #include "SDL.h"
 #undef main
 #include "window.h"
 #include "base64.h"
+#include "layerdata.h"
 #include "timer.h"
+#include "spatialhash.h"
+#include "actorstore.h"
+#include "chunkcache.h"
+#include "mapcache.h"
+#include "levelloader.h"
+#include "framestats.h"
+#include "atlas.h"
 #include "rapidxml.hpp"
 #include <iostream>
 
@@ -29,6 +40,13 @@ struct Camera
 	SDL_Rect view;
 	int velX, velY;
 
+	//Returns the part of the level in view. The size of view is in screen pixels, which are SIZE_FACTOR level pixels.
+	SDL_Rect levelView() const
+	{
+		SDL_Rect rect = { view.x, view.y, view.w / SIZE_FACTOR, view.h / SIZE_FACTOR };
+		return rect;
+	}
+
 };
 
 struct Tileset
@@ -42,23 +60,43 @@ struct Tileset
 		tileW = tileWidth;
 		tileH = tileHeight;
 		alpha = transparency;
+		margin = 0;
+		spacing = 0;
+		pixels = NULL;
+		page = NULL;
 	}
 
+	//The image belongs to the Window's texture cache and is released by whoever loaded it.
 	~Tileset() {
-		SDL_DestroyTexture(image); }
+		if (pixels != NULL)
+			SDL_FreeSurface(pixels); }
 
 	//first global tile id of the Tileset.
 	//This comes into play with multiple Tilesets.
 	int firstGid;				
 
-	//Source image of Tileset.
+	//Source image of Tileset, shared through the texture cache. NULL until the level is installed in the GameWorld.
 	SDL_Texture* image;			
 
-	//w: Width of the Tileset in tiles, not pixels.
-	//h: Height of the Tileset in tiles, not pixels.
+	//File name of the source image.
+	std::string source;
+
+	//Source image decoded by the level loader, waiting to be uploaded to image. NULL once uploaded.
+	SDL_Surface* pixels;
+
+	//Page of the GameWorld's texture atlas the image was packed into, or NULL if it is drawn from image.
+	//The clips of the Tileset's gids in the gid table are in the page instead of in image.
+	SDL_Texture* page;
+
+	//w: Width of the Tileset source image in pixels.
+	//h: Height of the Tileset source image in pixels.
 	//tileW & tileH: Width and height of each tile in pixels.
 	int w, h, tileW, tileH;			
 
+	//margin: Pixels around the edge of the source image.
+	//spacing: Pixels between neighbouring tiles in the source image.
+	int margin, spacing;
+
 	//value of color to be set transparent.
 	int alpha;					
 };
@@ -70,56 +108,197 @@ inline bool operator> (const Tileset& A, const Tileset& B) {
 inline bool operator<= (const Tileset&A, const Tileset& B) {
 	return !(A > B); }
 
-class Level
+inline bool compareByFirstGid(const Tileset* A, const Tileset* B) {
+	return *B > *A; }
+
+//Tiled stores flipping in the highest three bits of a gid. These are masked off to find the tile.
+const unsigned GID_FLIP_FLAGS = 0xE0000000u;
+
+//Strips the flip flags from a gid.
+inline int stripGidFlags(int gid) {
+	return static_cast<int>(static_cast<unsigned>(gid) & ~GID_FLIP_FLAGS); }
+
+//Entry of the gid lookup table, giving the Tileset and source image clip of a gid.
+struct GidEntry
+{
+	//Index of the Tileset in the Level's tileset list, or -1 if no Tileset owns the gid.
+	int tileset;
+
+	//Clip of the Tileset source image holding the tile.
+	SDL_Rect clip;
+};
+
+//Size in bytes of a cache line. Tile layers are aligned to this boundary.
+const int CACHE_LINE_SIZE = 64;
+
+//A single layer of tile gids, stored in one contiguous cache-aligned block.
+//Tiles are stored row by row (row-major), the same order that TMX layer data is decoded in,
+//so a tile is found with a single index instead of chasing a pointer per column.
+class TileLayer
 {
 public:
+	TileLayer(int width, int height)
+		:mWidth(width), mHeight(height)
+	{
+		//over-allocating by a cache line so the start of the data can be aligned
+		mBlock = new char[mWidth * mHeight * sizeof(int) + CACHE_LINE_SIZE];
+		uintptr_t aligned = (reinterpret_cast<uintptr_t>(mBlock) + CACHE_LINE_SIZE - 1) & ~static_cast<uintptr_t>(CACHE_LINE_SIZE - 1);
+		mData = reinterpret_cast<int*>(aligned);
+
+		//layers missing from the map are left empty (gid 0)
+		memset(mData, 0, mWidth * mHeight * sizeof(int));
+	}
 
-	//Dynamically allocating an array of gid, for map
-	Level(int width, int height, int tileW, int tileH, SDL_Texture* parallax = NULL)
-		:mWidth(width), mHeight(height), mTileWidth(tileW), mTileHeight(tileH), mParallaxBg(parallax)
+	//Wraps gids held elsewhere, such as in a memory mapped map cache, without copying them.
+	//The memory must hold width * height gids and outlive the layer.
+	TileLayer(int width, int height, int* data)
+		:mWidth(width), mHeight(height), mBlock(NULL), mData(data)
 	{
-		tileMap = new int*[mWidth];
-		for(int i = 0; i < mWidth; i++)
-			tileMap[i] = new int[mHeight];
+	}
 
-		tileMap2 = new int*[mWidth];
-		for (int i = 0; i < mWidth; i++)
-			tileMap2[i] = new int[mHeight];
+	~TileLayer() {
+		delete[] mBlock; }
 
-		overMap = new int*[mWidth];
-		for (int i = 0; i < mWidth; i++)
-			overMap[i] = new int[mHeight];
+	//Return the gid of the tile at (x, y). Coordinates are in tiles and are not bounds checked.
+	int at(int x, int y) const { return mData[y * mWidth + x]; }
 
-		overMap2 = new int*[mWidth];
-		for (int i = 0; i < mWidth; i++)
-			overMap2[i] = new int[mHeight];
-	}
+	//Set the gid of the tile at (x, y).
+	void set(int x, int y, int gid) { mData[y * mWidth + x] = gid; }
 
-	//Deleting dynamically allocated array, and all Tileset data associated with the Level.
-	~Level()
+	//Return a pointer to the first tile of row y.
+	int* row(int y) { return mData + y * mWidth; }
+	const int* row(int y) const { return mData + y * mWidth; }
+
+	//Return a pointer to the first tile of the layer. The layer holds getSize() gids.
+	int* data() { return mData; }
+	const int* data() const { return mData; }
+
+	int getWidth() const { return mWidth; }
+	int getHeight() const { return mHeight; }
+	int getSize() const { return mWidth * mHeight; }
+
+private:
+	//Layers are not copied.
+	TileLayer(const TileLayer&);
+	TileLayer& operator= (const TileLayer&);
+
+	int mWidth, mHeight;
+	char* mBlock;			//raw allocation, released in the destructor; NULL if the layer wraps memory it does not own
+	int* mData;				//cache-aligned start of the gids
+};
+
+//Indices of the tile layers of a Level, named after their TMX layer names.
+enum LayerIndex
+{
+	LAYER_BACKGROUND,		//"background"
+	LAYER_BACKGROUND2,		//"background2"
+	LAYER_OVERLAYER,		//"overlayer"
+	LAYER_OVERLAYER2,		//"overlayer2"
+	NUM_LAYERS
+};
+
+typedef std::vector<std::pair<std::string, std::string> > PropertyList;
+
+//Returns the value of a property, or an empty string if the list does not have it.
+inline std::string findProperty(const PropertyList &properties, const std::string &name)
+{
+	for (PropertyList::const_iterator iter = properties.begin(); iter != properties.end(); iter++)
 	{
-		for (int i = 0; i < mWidth; i++)
-			delete tileMap[i];
-		delete tileMap;
+		if (iter->first == name)
+			return iter->second;
+	}
+	return "";
+}
+
+//Most parallax layers a map can have: "parallaxBg", then "parallaxBg2" up to "parallaxBg8".
+const int MAX_PARALLAX_LAYERS = 8;
+
+//Scroll factor of parallax layers without a factor property.
+const float DEFAULT_PARALLAX_FACTOR = 0.5f;
+
+//A background image repeated across the screen behind the level, scrolling slower than the level so that it looks further away.
+struct ParallaxLayer
+{
+	//File name of the image.
+	std::string source;
 
-		for (int i = 0; i < mWidth; i++)
-			delete tileMap2[i];
-		delete tileMap2;
+	//How far the image scrolls for each pixel the camera moves: 0 keeps it still on screen, 1 scrolls it with the level.
+	float factorX, factorY;
 
-		for (int i = 0; i < mWidth; i++)
-			delete overMap[i];
-		delete overMap;
+	//Image of the layer, shared through the texture cache. NULL until the level is installed in the GameWorld.
+	SDL_Texture* image;
 
+	//Size of the image in pixels, set when it is installed.
+	int w, h;
 
-		for (int i = 0; i < mWidth; i++)
-			delete overMap2[i];
-		delete overMap2;
+	//Image decoded by the level loader, waiting to be uploaded to image. The Level owns the surface until it is taken.
+	SDL_Surface* pixels;
+};
+
+//An object from one of the map's object groups, such as a spawn point or an exit.
+struct MapObject
+{
+	std::string group;			//name of the object group
+	std::string name;
+	std::string type;
+	SDL_Rect box;				//position and size in pixels
+	PropertyList properties;
+};
 
-		for(std::set<Tileset*>::iterator iter = mTileset.begin(); iter != mTileset.end(); iter++)
+class MappedFile;
+
+class Level
+{
+public:
+
+	//Tile layers are added by the map loader, either with createLayers() or setLayer().
+	Level(int width, int height, int tileW, int tileH)
+		:mWidth(width), mHeight(height), mTileWidth(tileW), mTileHeight(tileH), mMapping(NULL)
+	{
+		for (int i = 0; i < NUM_LAYERS; i++)
+			mLayers[i] = NULL;
+	}
+
+	//Deleting all Tileset data and tile layers associated with the Level.
+	//Its images belong to the texture cache and are released by GameWorld::closeLevel().
+	//Layers may point into the map cache mapping, so the mapping is closed last.
+	~Level()
+	{
+		for(std::vector<Tileset*>::iterator iter = mTileset.begin(); iter != mTileset.end(); iter++)
 			delete *iter;
 
+		for (int i = 0; i < NUM_LAYERS; i++)
+			delete mLayers[i];
+
+		for (std::vector<ParallaxLayer>::iterator iter = mParallax.begin(); iter != mParallax.end(); iter++)
+		{
+			if (iter->pixels != NULL)
+				SDL_FreeSurface(iter->pixels);
+		}
+
+		delete mMapping;
 	}
 
+	//Allocates an empty contiguous layer of gids for every tile layer.
+	void createLayers()
+	{
+		for (int i = 0; i < NUM_LAYERS; i++)
+			setLayer(i, new TileLayer(mWidth, mHeight));
+	}
+
+	//Replaces a tile layer. The Level takes ownership of the layer.
+	void setLayer(int index, TileLayer* layer)
+	{
+		delete mLayers[index];
+		mLayers[index] = layer;
+	}
+
+	//Return a tile layer by LayerIndex.
+	TileLayer* getLayer(int index) { return mLayers[index]; }
+
+	//Keeps a memory mapped file open for as long as the Level exists. The Level takes ownership of the mapping.
+	void setMapping(MappedFile* mapping) { mMapping = mapping; }
+
 	//Return the width of the level in tiles, not pixels.
 	int getWidth() {return mWidth;}
 
@@ -132,37 +311,203 @@ public:
 	//Return the height of each tile in pixels.
 	int getTileHeight() {return mTileHeight;}
 
-	//Return the pointer to the first element of the tilemap.
-	int** getTileMap() { return tileMap; }
+	//Return the background tile layer.
+	TileLayer* getTileMap() { return mLayers[LAYER_BACKGROUND]; }
+
+	//Return pointer to the Tileset list. It is ordered by first gid once buildGidTable() has been called.
+	std::vector<Tileset*>* getTileSet() {return &mTileset;}
+
+	//Sorts the Tilesets by first gid and builds the table giving the Tileset and source clip of every gid.
+	//Must be called once all Tilesets have been read.
+	void buildGidTable()
+	{
+		std::sort(mTileset.begin(), mTileset.end(), compareByFirstGid);
+
+		GidEntry empty = { -1, { 0, 0, 0, 0 } };
+		mGidTable.assign(1, empty);
+
+		for (int i = 0; i < static_cast<int>(mTileset.size()); i++)
+		{
+			Tileset* tileset = mTileset[i];
+			if (tileset->tileW <= 0 || tileset->tileH <= 0)
+				continue;
+
+			//Finding the number of tiles in the tileset source image.
+			int numTilesX = (tileset->w - 2 * tileset->margin + tileset->spacing) / (tileset->tileW + tileset->spacing);
+			int numTilesY = (tileset->h - 2 * tileset->margin + tileset->spacing) / (tileset->tileH + tileset->spacing);
+			if (numTilesX <= 0 || numTilesY <= 0)
+				continue;
+
+			//A Tileset owns the gids up to the first gid of the next Tileset.
+			int lastGid = tileset->firstGid + numTilesX * numTilesY;
+			if (i + 1 < static_cast<int>(mTileset.size()))
+				lastGid = std::min(lastGid, mTileset[i + 1]->firstGid);
+
+			if (lastGid > static_cast<int>(mGidTable.size()))
+				mGidTable.resize(lastGid, empty);
+
+			for (int gid = tileset->firstGid; gid < lastGid; gid++)
+			{
+				int tileIndex = gid - tileset->firstGid;
+				GidEntry &entry = mGidTable[gid];
+				entry.tileset = i;
+				entry.clip.x = tileset->margin + (tileIndex % numTilesX) * (tileset->tileW + tileset->spacing);
+				entry.clip.y = tileset->margin + (tileIndex / numTilesX) * (tileset->tileH + tileset->spacing);
+				entry.clip.w = tileset->tileW;
+				entry.clip.h = tileset->tileH;
+			}
+		}
+	}
 
-	//Return pointer to the Tileset set. 
-	std::set<Tileset*>* getTileSet() {return &mTileset;}
+	//Return the gid table entry of a gid, ignoring flip flags, or NULL if the gid is empty or out of range.
+	const GidEntry* getGidEntry(int gid) const
+	{
+		unsigned index = static_cast<unsigned>(stripGidFlags(gid));
+		if (index >= mGidTable.size() || mGidTable[index].tileset < 0)
+			return NULL;
+		return &mGidTable[index];
+	}
 
 	//Return pointer to the set of solid gids.
 	std::set<int>* getSolidGid() { return &mSolidGid; }
 
-	int** getTileMap2() { return tileMap2; }
+	//Builds the dense gid solidity table from the set of solid gids.
+	void buildSolidTable()
+	{
+		int maxGid = mSolidGid.empty() ? 0 : *mSolidGid.rbegin();
+		mSolidTable.assign(maxGid + 1, 0);
+		for (std::set<int>::iterator iter = mSolidGid.begin(); iter != mSolidGid.end(); iter++)
+		{
+			if (*iter >= 0)
+				mSolidTable[*iter] = 1;
+		}
+	}
+
+	//Builds the dense gid solidity table and the per tile solid bitmap from the set of solid gids.
+	//Must be called once all tilesets and the background layers have been read.
+	void buildSolidMap()
+	{
+		buildSolidTable();
+
+		//one bit per tile, set if the tile in either background layer is solid
+		mSolidMap.assign((mWidth * mHeight + 31) / 32, 0);
+		const int* background = mLayers[LAYER_BACKGROUND]->data();
+		const int* background2 = mLayers[LAYER_BACKGROUND2]->data();
+		for (int i = 0; i < mWidth * mHeight; i++)
+		{
+			if (isSolidGid(background[i]) || isSolidGid(background2[i]))
+				mSolidMap[i >> 5] |= 1u << (i & 31);
+		}
+	}
 
-	int** getOverMap() { return overMap; }
+	//Return whether a gid is solid, using the dense solidity table. Flipped tiles are as solid as unflipped ones.
+	bool isSolidGid(int gid) const
+	{
+		unsigned index = static_cast<unsigned>(stripGidFlags(gid));
+		return index < mSolidTable.size() && mSolidTable[index] != 0;
+	}
 
-	int** getOverMap2() { return overMap2; }
+	//Return whether the tile at (x, y) is solid in either background layer.
+	//Coordinates are in tiles and are not bounds checked.
+	bool isSolid(int x, int y) const
+	{
+		int i = y * mWidth + x;
+		return ((mSolidMap[i >> 5] >> (i & 31)) & 1) != 0;
+	}
 
-	SDL_Texture* getParallax() { return mParallaxBg; }
+	//Return the gid lookup table, indexed by gid.
+	std::vector<GidEntry>* getGidTable() { return &mGidTable; }
+
+	//Return the solid bitmap, one bit per tile.
+	std::vector<Uint32>* getSolidMap() { return &mSolidMap; }
+
+	TileLayer* getTileMap2() { return mLayers[LAYER_BACKGROUND2]; }
+
+	TileLayer* getOverMap() { return mLayers[LAYER_OVERLAYER]; }
+
+	TileLayer* getOverMap2() { return mLayers[LAYER_OVERLAYER2]; }
+
+	//Return the parallax layers, from the furthest back to the closest.
+	std::vector<ParallaxLayer>* getParallaxLayers() { return &mParallax; }
+
+	//Builds the parallax layers from the map properties. Must be called once the properties have been read.
+	//Layer n has its image in the property "parallaxBg" (n = 1) or "parallaxBg<n>", and its scroll factor in "parallaxBgFactor"
+	//or "parallaxBg<n>Factor", either as a single number or as "x,y". Layers are numbered from the furthest back.
+	void buildParallaxLayers()
+	{
+		mParallax.clear();
+		for (int n = 1; n <= MAX_PARALLAX_LAYERS; n++)
+		{
+			std::ostringstream name;
+			name << "parallaxBg";
+			if (n > 1)
+				name << n;
+
+			ParallaxLayer layer = { findProperty(mProperties, name.str()), DEFAULT_PARALLAX_FACTOR, DEFAULT_PARALLAX_FACTOR, NULL, 0, 0, NULL };
+			if (layer.source == "")
+				continue;
+
+			std::string factor = findProperty(mProperties, name.str() + "Factor");
+			if (factor != "" && sscanf(factor.c_str(), "%f,%f", &layer.factorX, &layer.factorY) == 1)
+				layer.factorY = layer.factorX;
+
+			mParallax.push_back(layer);
+		}
+	}
+
+	//Return the custom properties of the map.
+	PropertyList* getProperties() { return &mProperties; }
+
+	//Return the objects of all object groups.
+	std::vector<MapObject>* getObjects() { return &mObjects; }
+
+	//Return the index-th object of an object group, or NULL if there is no such object.
+	MapObject* findObject(const std::string &group, int index = 0)
+	{
+		for (std::vector<MapObject>::iterator iter = mObjects.begin(); iter != mObjects.end(); iter++)
+		{
+			if (iter->group == group && index-- == 0)
+				return &*iter;
+		}
+		return NULL;
+	}
 
 private:
 	int mWidth, mHeight, mTileWidth, mTileHeight;
 	bool mVisible;
-	int** tileMap;
-	int** tileMap2;
-	int** overMap;
-	int** overMap2;
+	TileLayer* mLayers[NUM_LAYERS];
 
-	std::set<Tileset*> mTileset;
+	std::vector<Tileset*> mTileset;
+	std::vector<GidEntry> mGidTable;			//Tileset and source clip of each gid, indexed by gid
 	std::set<int> mSolidGid;
-	SDL_Texture* mParallaxBg;
+	std::vector<unsigned char> mSolidTable;		//solidity of each gid, indexed by gid
+	std::vector<Uint32> mSolidMap;				//one solid bit per tile of the merged background layers
+	PropertyList mProperties;
+	std::vector<MapObject> mObjects;
+	std::vector<ParallaxLayer> mParallax;
+	MappedFile* mMapping;						//map cache the layers may point into, or NULL
+
+	//Levels own their layers and tilesets and are not copied.
+	Level(const Level&);
+	Level& operator= (const Level&);
 
 };
 
+//How Actors are moved and collided with.
+//COLLISION_DISCRETE moves an Actor by its whole movement, then pushes it out of whatever it overlaps.
+//A long frame can move an Actor far enough to pass straight through a wall.
+//COLLISION_SWEPT sweeps the collision box along its movement, stops it at the first solid tile or Actor in its way
+//and slides it along that surface, so any timestep is safe. Overlaps are still corrected afterwards.
+enum CollisionMode { COLLISION_DISCRETE, COLLISION_SWEPT };
+
+//The simulation runs at a fixed rate, independent of the render rate.
+//Each simulation tick advances the world by SIMULATION_STEP milliseconds.
+const int SIMULATION_RATE = 60;
+const float SIMULATION_STEP = 1000.f / SIMULATION_RATE;
+
+//Distance in pixels from a playerExit object at which the player starts preloading the exit's map.
+const int EXIT_PRELOAD_DISTANCE = 160;
+
 class GameWorld
 {
 public:
@@ -178,29 +523,63 @@ public:
 
 	void moveActors();
 	void drawActors();
-	void drawBackground(int** tilemap);
+	void drawBackground(TileLayer* tilemap);
 	void parallaxBg();
 
 	void spawnPlayer(SDL_Texture *sprite, SDL_Rect* clip = NULL, SDL_Rect* colBox = NULL, int colBoxX = 0, int colBoxY = 0, int x = 0, int y = 0);
-	void spawnActor(SDL_Texture *sprite, int x = 0, int y = 0, SDL_Rect* collisionBox = NULL);
+	void spawnActor(SDL_Texture *sprite, int x = 0, int y = 0, SDL_Rect* collisionBox = NULL, SDL_Rect* clip = NULL);
 
 	//Toggle collision box visibility.
 	void toggleColBox();
 
+	//Toggle the performance overlay, which the main loop draws over the game states.
+	void toggleOverlay() { mOverlayOn = !mOverlayOn; }
+	bool isOverlayOn() const { return mOverlayOn; }
+
+	void setCollisionMode(CollisionMode mode) { mCollisionMode = mode; }
+	CollisionMode getCollisionMode() const { return mCollisionMode; }
+
 	void openCharTiles(std::string imageSource, int tileWidth, int tileHeight, int alpha = 0)
 	{
 		SDL_Texture* source = mWindow->LoadImage(imageSource);
 		int w,h = 0;
 
 		SDL_QueryTexture(source, NULL,  NULL, &w, &h);
+		if (mCharSprites != NULL)
+		{
+			mWindow->ReleaseImage(mCharSprites->image);
+			delete mCharSprites;
+		}
 		mCharSprites = new Tileset(source, 1, w, h, tileWidth, tileHeight, alpha);
 	}
 
+	//Returns the clip of a character of the character sprite sheet, in the image returned by getCharImage().
 	SDL_Rect getCharClip(int index);
 
-	//Opens a .TMX map file.
+	//Returns the image characters are drawn from: the atlas page the character sprite sheet was packed into,
+	//or the sheet itself. The sheet is packed when a level is installed.
+	SDL_Texture* getCharImage() { return mCharPage != NULL ? mCharPage : mCharSprites->image; }
+
+	//Opens a .TMX map file. Any level that is already open is closed first.
 	void openMap(std::string title);
 
+	//Deletes the current level, along with all Actors in it and everything cached from it.
+	void closeLevel();
+
+	//Makes a loaded level the current level: uploads its images and spawns the player. The GameWorld takes ownership of the level.
+	void installLevel(Level* level);
+
+	//Starts loading a .TMX map in the background, so that opening it later only has to upload its images.
+	void preloadMap(const std::string &title) { mLevelLoader.request(title); }
+
+	//Once the mLoadNextLevel trigger is activated, loads mNextLevel in the background and switches to it when it is ready.
+	//If the map cannot be loaded, the error is logged and the current level keeps running.
+	//Returns true on the update the level changes.
+	bool updateLevelLoad();
+
+	//Preloads the map of any playerExit object the player is close to, and triggers the level change when the player walks into one.
+	void checkExits();
+
 	Player* getPlayer() { return mPlayer; }
 	Camera* getCamera() { return &mCamera; }
 	Level* getLevel() { return mLevel; }
@@ -210,23 +589,56 @@ public:
 	bool shouldLoadNextLevel() { return mLoadNextLevel; }
 	std::string getNextLevel() { return mNextLevel; }
 	void setNextLevel(std::string source) {mNextLevel = source; }
+	void setNextPlayerSpawn(int spawn) { mNextPlayerSpawn = spawn; }
 	Tileset* getCharSprites() { return mCharSprites; }
 	bool getDebugInfo() { return mDebugOn; }
 	Window* getWin() { return mWindow; }
 	std::vector<Actor*>* getActorList() { return &actorList; }
-	Timer* getTime() { return &mDeltaTime; }
+	ActorStore* getActorStore() { return &mActorStore; }
+
+	//Sets how far rendering is between the previous and the current simulation tick, from 0 to 1,
+	//and moves the camera to the player's interpolated position.
+	void setInterpolation(float alpha);
+	float getInterpolation() const { return mInterpolation; }
+
+	//Milliseconds since the world was created. Actors time their animations with it,
+	//so that drawActors() reads the clock once per frame instead of once per Actor.
+	double getAnimationTime() const { return mAnimationClock.Milliseconds(); }
+
+	//Number of Actors drawn and culled by the last drawActors().
+	int getActorsDrawn() const { return mActorsDrawn; }
+	int getActorsCulled() const { return mActorsCulled; }
+	SpatialHash* getSpatialHash() { return &mSpatialHash; }
+	TextureAtlas* getAtlas() { return &mAtlas; }
+	ChunkCache* getChunkCache() { return &mChunkCache; }
+
+	//Memory taken by the textures of the world and its window, in bytes: cached images, atlas pages, chunks and glyph pages.
+	Uint64 getTextureMemory();
+
+	//Turns collecting FrameStats on or off. Collecting them costs a few performance counter reads per Actor.
+	void enableStats(bool enable) { mStatsEnabled = enable; }
+	FrameStats* getStats() { return &mStats; }
 
 private:
+	//Positions, velocities and collision boxes of every Actor. Declared before the Actors so that it outlives them.
+	ActorStore mActorStore;
+
 	std::vector<Actor*> actorList;
 
 	//Actor list sorted by bottom most to top most position of sprite.
 	//Used when ordering Actors in the orderedActors vector, so that Actors further down on screen are drawn first.
 	//This allows actors behind other Actors to actually appear behind other actors.
+	//Spawned Actors are appended, and drawActors() restores the order of the Actors in view every frame.
 	std::vector<Actor*> orderedActorList; 
 
+	//Actors in view during drawActors(), and their indices in orderedActorList. Kept between frames to avoid allocating.
+	std::vector<Actor*> mVisibleActors;
+	std::vector<size_t> mVisibleSlots;
+
 	std::vector<Tileset*> actorSprites;
 
 	bool mDebugOn;
+	bool mOverlayOn;
 	Player* mPlayer;
 	Camera mCamera; //contains dimensions of screen
 	Level *mLevel;
@@ -235,8 +647,57 @@ private:
 	SDL_Rect mPlayerSpawnPoint;
 	bool mLoadNextLevel;
 	std::string mNextLevel;
+	std::string mFailedLevel;	//map that last failed to load, ignored while the player is in its exit
 	Tileset* mCharSprites;
-	Timer mDeltaTime;
+	float mInterpolation;
+
+	//Broadphase for collisions between Actors, and a reusable list of the Actors it returns.
+	SpatialHash mSpatialHash;
+	std::vector<Actor*> mCollisionCandidates;
+
+	//Collision boxes of the candidates as separate arrays for the overlapBoxes() kernel, and its results.
+	std::vector<int> mCandidateX, mCandidateY, mCandidateW, mCandidateH;
+	std::vector<unsigned char> mCandidateHits;
+	CollisionMode mCollisionMode;
+
+	//Pre-rendered chunks of the static tile layers.
+	ChunkCache mChunkCache;
+
+	//Loads and preloads levels on a worker thread.
+	LevelLoader mLevelLoader;
+
+	bool mStatsEnabled;
+	FrameStats mStats;
+
+	//Tileset images and the character sprite sheet, packed together when a level is installed
+	//so that tiles and characters are drawn from the same texture.
+	TextureAtlas mAtlas;
+	SDL_Texture* mCharPage;			//atlas page holding the character sprite sheet, or NULL
+	SDL_Point mCharOffset;			//position of the character sprite sheet in mCharPage
+
+	//Packs the level's tileset images and the character sprite sheet into the atlas,
+	//and moves the clips of the gid table and of the characters into the atlas pages.
+	void buildAtlas();
+
+	Timer mAnimationClock;
+	int mActorsDrawn, mActorsCulled;
+
+	//Finds the tileset image and the clip of the image for a gid.
+	//Returns false if the gid is an empty tile.
+	bool getTileClip(int gid, SDL_Texture** image, SDL_Rect* clip);
+
+	//Moves an Actor by its velocity over ticks milliseconds, sweeping its collision box against solid tiles
+	//and other Actors. Used in COLLISION_SWEPT mode.
+	void sweepActor(std::vector<Actor*>::iterator curActor, float ticks);
+
+	//Releases the tileset and parallax images of a level back to the texture cache.
+	void releaseLevelImages(Level* level);
+
+	//Renders the tiles of a chunk into its texture.
+	void bakeChunk(Chunk* chunk);
+
+	//Draws the visible tiles of a layer one by one. Used when render targets are not supported.
+	void drawTiles(TileLayer* tilemap);
 
 
 	//Corrects collision between an Actor and another collision box.
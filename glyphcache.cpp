@@ -0,0 +1,129 @@
+#include "glyphcache.h"
+
+GlyphCache::GlyphCache()
+	:mRenderer(NULL)
+{
+}
+
+GlyphCache::~GlyphCache()
+{
+	clear();
+}
+
+TTF_Font* GlyphCache::getFont(const std::string &file, int size)
+{
+	std::pair<std::string, int> key(file, size);
+	std::map<std::pair<std::string, int>, TTF_Font*>::iterator found = mFonts.find(key);
+	if (found != mFonts.end())
+		return found->second;
+
+	//Fonts that cannot be opened are remembered as NULL, so that text drawn every frame with a missing font
+	//does not try to open the file every frame. TTF_GetError() only describes the first failure.
+	TTF_Font* font = TTF_OpenFont(file.c_str(), size);
+	mFonts[key] = font;
+	return font;
+}
+
+const Glyph* GlyphCache::getGlyph(TTF_Font* font, Uint16 character)
+{
+	std::map<Uint16, Glyph> &glyphs = mGlyphs[font];
+	std::map<Uint16, Glyph>::iterator found = glyphs.find(character);
+	if (found != glyphs.end())
+		return &found->second;
+
+	int minX, maxX, minY, maxY, advance;
+	if (TTF_GlyphMetrics(font, character, &minX, &maxX, &minY, &maxY, &advance) != 0)
+		return NULL;
+
+	Glyph glyph = { NULL, { 0, 0, 0, 0 }, minX < 0 ? minX : 0, advance };
+
+	//rendered in white, and tinted to the color of the text when drawn
+	SDL_Color white = { 255, 255, 255, 255 };
+	SDL_Surface* pixels = TTF_RenderGlyph_Blended(font, character, white);
+	if (pixels != NULL && pixels->w > 0 && pixels->h > 0)
+	{
+		bool placed = place(pixels, &glyph.page, &glyph.clip);
+		SDL_FreeSurface(pixels);
+		if (!placed)
+			return NULL;
+	}
+	else if (pixels != NULL)
+		SDL_FreeSurface(pixels);
+
+	return &(glyphs[character] = glyph);
+}
+
+bool GlyphCache::place(SDL_Surface* pixels, SDL_Texture** page, SDL_Rect* clip)
+{
+	//glyphs are padded like the texture atlas, so that filtering never blends in a neighbouring glyph
+	int w = pixels->w + ATLAS_PADDING;
+	int h = pixels->h + ATLAS_PADDING;
+	if (w > GLYPH_PAGE_SIZE || h > GLYPH_PAGE_SIZE)
+		return false;
+
+	SDL_Point position;
+	int index = -1;
+	for (size_t i = 0; i < mPackers.size() && index < 0; i++)
+	{
+		if (mPackers[i].pack(w, h, &position))
+			index = static_cast<int>(i);
+	}
+
+	if (index < 0)
+	{
+		SDL_Texture* texture = SDL_CreateTexture(mRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, GLYPH_PAGE_SIZE, GLYPH_PAGE_SIZE);
+		if (texture == NULL)
+			return false;
+
+		//new textures are not cleared, so the page starts out transparent
+		std::vector<Uint32> transparent(GLYPH_PAGE_SIZE * GLYPH_PAGE_SIZE, 0);
+		SDL_UpdateTexture(texture, NULL, &transparent[0], GLYPH_PAGE_SIZE * sizeof(Uint32));
+		SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+		mPages.push_back(texture);
+		mPackers.push_back(SkylinePacker(GLYPH_PAGE_SIZE, GLYPH_PAGE_SIZE));
+		index = static_cast<int>(mPages.size()) - 1;
+		mPackers[index].pack(w, h, &position);
+	}
+
+	SDL_Surface* converted = SDL_ConvertSurfaceFormat(pixels, SDL_PIXELFORMAT_ARGB8888, 0);
+	if (converted == NULL)
+		return false;
+
+	clip->x = position.x;
+	clip->y = position.y;
+	clip->w = pixels->w;
+	clip->h = pixels->h;
+	SDL_UpdateTexture(mPages[index], clip, converted->pixels, converted->pitch);
+	SDL_FreeSurface(converted);
+
+	*page = mPages[index];
+	return true;
+}
+
+void GlyphCache::clear()
+{
+	for (std::map<std::pair<std::string, int>, TTF_Font*>::iterator iter = mFonts.begin(); iter != mFonts.end(); iter++)
+	{
+		if (iter->second != NULL)
+			TTF_CloseFont(iter->second);
+	}
+	for (std::vector<SDL_Texture*>::iterator iter = mPages.begin(); iter != mPages.end(); iter++)
+		SDL_DestroyTexture(*iter);
+
+	mFonts.clear();
+	mGlyphs.clear();
+	mPages.clear();
+	mPackers.clear();
+}
+
+int GlyphCache::getFontCount() const
+{
+	int count = 0;
+	for (std::map<std::pair<std::string, int>, TTF_Font*>::const_iterator iter = mFonts.begin(); iter != mFonts.end(); iter++)
+	{
+		if (iter->second != NULL)
+			count++;
+	}
+	return count;
+}
@@ -0,0 +1,91 @@
+#ifndef GLYPHCACHE_H
+#define GLYPHCACHE_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#if defined(_MSC_VER)
+#include <SDL.h>
+#include <SDL_ttf.h>
+#elif defined(__clang__)
+#include <SDL2/SDL.h>
+#include <SDL2_ttf/SDL_ttf.h>
+#else
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#endif
+
+#include "atlas.h"
+
+//Width and height of a glyph atlas page. A page holds a few hundred glyphs of a 16 point font.
+const int GLYPH_PAGE_SIZE = 512;
+
+//A glyph rasterised into a glyph atlas page.
+struct Glyph
+{
+	//Page of the glyph atlas holding the glyph, or NULL for glyphs without pixels, such as spaces.
+	SDL_Texture* page;
+
+	//Where the glyph is in the page. The glyph is as tall as a line of its font, so every glyph of a line is drawn at the same y.
+	SDL_Rect clip;
+
+	//Pixels from the pen position to the left edge of the glyph, which is negative for glyphs that reach back over the previous one.
+	int offsetX;
+
+	//Pixels the pen moves right after the glyph, before kerning.
+	int advance;
+};
+
+//Cache of open fonts and of the glyphs rendered with them.
+//Fonts are opened the first time a file and size are used, and stay open until the cache is cleared.
+//Each glyph is rasterised once, in white, into a shared atlas of glyph pages, so that drawing text only takes
+//one textured quad per glyph, tinted to the text color, which the sprite batch of Window draws together.
+class GlyphCache
+{
+public:
+	GlyphCache();
+
+	//Closes every font and destroys the pages.
+	~GlyphCache();
+
+	//Sets the renderer pages are created with. Must be called before any glyph is rendered.
+	void setRenderer(SDL_Renderer* renderer) { mRenderer = renderer; }
+
+	//Returns a font at a point size, opening it on first use. Returns NULL if the font cannot be opened.
+	//A font that fails to open is not tried again until the cache is cleared.
+	TTF_Font* getFont(const std::string &file, int size);
+
+	//Returns a glyph of a font, rasterising it on first use.
+	//Returns NULL if the font has no such glyph, or if the glyph does not fit in a page.
+	const Glyph* getGlyph(TTF_Font* font, Uint16 character);
+
+	//Closes every font and destroys the pages. Must be called before the renderer is destroyed and TTF_Quit().
+	void clear();
+
+	//Number of fonts open, not counting those that failed to open.
+	int getFontCount() const;
+	int getPageCount() const { return static_cast<int>(mPages.size()); }
+
+	//Memory taken by the pages, in bytes. Every page is a GLYPH_PAGE_SIZE square of 32 bit pixels.
+	Uint64 getMemory() const { return static_cast<Uint64>(mPages.size()) * GLYPH_PAGE_SIZE * GLYPH_PAGE_SIZE * sizeof(Uint32); }
+
+private:
+	//Copies a rasterised glyph into the first page with room for it, starting a new page if there is none.
+	//Returns false if it does not fit in an empty page.
+	bool place(SDL_Surface* pixels, SDL_Texture** page, SDL_Rect* clip);
+
+	SDL_Renderer* mRenderer;
+
+	std::map<std::pair<std::string, int>, TTF_Font*> mFonts;		//by file name and point size, NULL for fonts that failed to open
+	std::map<TTF_Font*, std::map<Uint16, Glyph> > mGlyphs;			//glyphs of each font, by character
+
+	std::vector<SDL_Texture*> mPages;
+	std::vector<SkylinePacker> mPackers;		//free space of each page
+
+	//Fonts and pages are owned by the cache and are not copied.
+	GlyphCache(const GlyphCache&);
+	GlyphCache& operator= (const GlyphCache&);
+};
+
+#endif
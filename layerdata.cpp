@@ -0,0 +1,125 @@
+#include "layerdata.h"
+#include "base64fast.h"
+
+#include <stdexcept>
+#include <zlib.h>
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
+//Size of the block that compressed data is base64 decoded into before it is inflated.
+const size_t INFLATE_BLOCK_SIZE = 16 * 1024;
+
+//Decodes and inflates zlib or gzip compressed data.
+static size_t inflateZlib(const char* text, size_t length, unsigned char* dst, size_t dstLen)
+{
+	z_stream stream;
+	stream.zalloc = Z_NULL;
+	stream.zfree = Z_NULL;
+	stream.opaque = Z_NULL;
+	stream.next_in = Z_NULL;
+	stream.avail_in = 0;
+
+	//adding 32 to the window bits detects zlib and gzip headers automatically
+	if (inflateInit2(&stream, 15 + 32) != Z_OK)
+		throw std::runtime_error("Failed to start inflating layer data");
+
+	stream.next_out = dst;
+	stream.avail_out = static_cast<uInt>(dstLen);
+
+	unsigned char block[INFLATE_BLOCK_SIZE];
+	int result = Z_OK;
+
+	while (result != Z_STREAM_END && stream.avail_out != 0)
+	{
+		//refilling the input block from the base64 text
+		if (stream.avail_in == 0)
+		{
+			size_t used;
+			size_t decoded = base64_decode_fast(text, length, block, INFLATE_BLOCK_SIZE, &used);
+			text += used;
+			length -= used;
+
+			if (decoded == 0)
+				break;
+
+			stream.next_in = block;
+			stream.avail_in = static_cast<uInt>(decoded);
+		}
+
+		result = inflate(&stream, Z_NO_FLUSH);
+		if (result != Z_OK && result != Z_STREAM_END)
+		{
+			inflateEnd(&stream);
+			throw std::runtime_error("Corrupt zlib layer data");
+		}
+	}
+
+	size_t written = dstLen - stream.avail_out;
+	inflateEnd(&stream);
+	return written;
+}
+
+#ifdef USE_ZSTD
+//Decodes and decompresses zstd compressed data.
+static size_t inflateZstd(const char* text, size_t length, unsigned char* dst, size_t dstLen)
+{
+	ZSTD_DCtx* context = ZSTD_createDCtx();
+	if (context == NULL)
+		throw std::runtime_error("Failed to start decompressing layer data");
+
+	unsigned char block[INFLATE_BLOCK_SIZE];
+	ZSTD_inBuffer input = { block, 0, 0 };
+	ZSTD_outBuffer output = { dst, dstLen, 0 };
+
+	while (output.pos < output.size)
+	{
+		//refilling the input block from the base64 text
+		if (input.pos == input.size)
+		{
+			size_t used;
+			input.size = base64_decode_fast(text, length, block, INFLATE_BLOCK_SIZE, &used);
+			input.pos = 0;
+			text += used;
+			length -= used;
+
+			if (input.size == 0)
+				break;
+		}
+
+		size_t result = ZSTD_decompressStream(context, &output, &input);
+		if (ZSTD_isError(result))
+		{
+			ZSTD_freeDCtx(context);
+			throw std::runtime_error(std::string("Corrupt zstd layer data: ") + ZSTD_getErrorName(result));
+		}
+
+		//0 means the frame is complete
+		if (result == 0)
+			break;
+	}
+
+	ZSTD_freeDCtx(context);
+	return output.pos;
+}
+#endif
+
+size_t decodeLayerData(const char* text, size_t length, const std::string &encoding, const std::string &compression,
+	unsigned char* dst, size_t dstLen)
+{
+	if (encoding != "base64")
+		throw std::runtime_error("Unsupported layer encoding: " + encoding);
+
+	if (compression.empty())
+		return base64_decode_fast(text, length, dst, dstLen);
+
+	if (compression == "zlib" || compression == "gzip")
+		return inflateZlib(text, length, dst, dstLen);
+
+#ifdef USE_ZSTD
+	if (compression == "zstd")
+		return inflateZstd(text, length, dst, dstLen);
+#endif
+
+	throw std::runtime_error("Unsupported layer compression: " + compression);
+}
@@ -0,0 +1,21 @@
+#ifndef LAYERDATA_H
+#define LAYERDATA_H
+
+#include <string>
+#include <cstddef>
+
+//Decodes the text of a TMX layer's <data> node straight into a tile buffer.
+//Handles base64 encoded data, either uncompressed or compressed with zlib, gzip or zstd.
+//Compressed data is inflated as it is decoded, a small block at a time, so the decoded layer is never held as a whole in memory.
+//Throws a runtime_error for unsupported encodings or corrupt data.
+//@param text The text of the <data> node
+//@param length The number of characters in text
+//@param encoding The "encoding" attribute of the <data> node
+//@param compression The "compression" attribute of the <data> node, or an empty string if there is none
+//@param dst The buffer to decode into
+//@param dstLen The size of dst in bytes
+//@return The number of bytes written to dst
+size_t decodeLayerData(const char* text, size_t length, const std::string &encoding, const std::string &compression,
+	unsigned char* dst, size_t dstLen);
+
+#endif
@@ -0,0 +1,189 @@
+#include "levelloader.h"
+#include "maploader.h"
+#include "gameworld.h"
+
+#include <stdexcept>
+
+LevelLoader::LevelLoader(TextureCache* cache)
+	:mQuit(false), mCache(cache)
+{
+	mWorker = std::thread(&LevelLoader::workerLoop, this);
+}
+
+LevelLoader::~LevelLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQuit = true;
+	}
+	mWorkQueued.notify_all();
+	mWorker.join();
+
+	for (std::list<Job>::iterator iter = mJobs.begin(); iter != mJobs.end(); iter++)
+		delete iter->level;
+}
+
+void LevelLoader::request(const std::string &title)
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (findJob(title) != mJobs.end())
+			return;
+
+		Job job;
+		job.title = title;
+		job.state = JOB_QUEUED;
+		job.level = NULL;
+		job.wanted = false;
+		mJobs.push_back(job);
+	}
+	mWorkQueued.notify_one();
+}
+
+bool LevelLoader::isRequested(const std::string &title)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return findJob(title) != mJobs.end();
+}
+
+Level* LevelLoader::take(const std::string &title)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	std::list<Job>::iterator job = findJob(title);
+	if (job == mJobs.end())
+		return NULL;
+
+	if (job->state != JOB_DONE)
+	{
+		job->wanted = true;
+		return NULL;
+	}
+
+	return takeJob(job);
+}
+
+Level* LevelLoader::wait(const std::string &title)
+{
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		std::list<Job>::iterator job = findJob(title);
+		if (job != mJobs.end())
+		{
+			//a wanted job is never discarded, and only the main thread takes jobs, so the iterator stays valid
+			job->wanted = true;
+			while (job->state != JOB_DONE)
+				mWorkDone.wait(lock);
+
+			return takeJob(job);
+		}
+	}
+
+	//not requested, so there is nothing to wait for
+	return load(title);
+}
+
+Level* LevelLoader::load(const std::string &title)
+{
+	Level* level = loadLevel(title);
+	try
+	{
+		loadLevelImages(level, mCache);
+	}
+	catch (...)
+	{
+		delete level;
+		throw;
+	}
+	return level;
+}
+
+void LevelLoader::workerLoop()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	while (true)
+	{
+		//finding the oldest queued job
+		std::list<Job>::iterator job = mJobs.begin();
+		while (job != mJobs.end() && job->state != JOB_QUEUED)
+			job++;
+
+		if (mQuit)
+			return;
+
+		if (job == mJobs.end())
+		{
+			mWorkQueued.wait(lock);
+			continue;
+		}
+
+		//loading without the lock, so the main thread can request and take other levels meanwhile
+		job->state = JOB_LOADING;
+		std::string title = job->title;
+		lock.unlock();
+
+		Level* level = NULL;
+		std::string error;
+		try
+		{
+			level = load(title);
+		}
+		catch (const std::exception &e)
+		{
+			error = e.what();
+		}
+
+		lock.lock();
+		job->state = JOB_DONE;
+		job->level = level;
+		job->error = error;
+		trimFinished();
+		mWorkDone.notify_all();
+	}
+}
+
+std::list<LevelLoader::Job>::iterator LevelLoader::findJob(const std::string &title)
+{
+	for (std::list<Job>::iterator iter = mJobs.begin(); iter != mJobs.end(); iter++)
+	{
+		if (iter->title == title)
+			return iter;
+	}
+	return mJobs.end();
+}
+
+Level* LevelLoader::takeJob(std::list<Job>::iterator job)
+{
+	Level* level = job->level;
+	std::string error = job->error;
+	mJobs.erase(job);
+
+	if (level == NULL)
+		throw std::runtime_error("Failed to load map: " + error);
+	return level;
+}
+
+void LevelLoader::trimFinished()
+{
+	int finished = 0;
+	for (std::list<Job>::iterator iter = mJobs.begin(); iter != mJobs.end(); iter++)
+	{
+		if (iter->state == JOB_DONE && !iter->wanted)
+			finished++;
+	}
+
+	//jobs are in request order, so the first finished jobs are the oldest
+	for (std::list<Job>::iterator iter = mJobs.begin(); iter != mJobs.end() && finished > MAX_PRELOADED_LEVELS;)
+	{
+		if (iter->state == JOB_DONE && !iter->wanted)
+		{
+			delete iter->level;
+			iter = mJobs.erase(iter);
+			finished--;
+		}
+		else
+			iter++;
+	}
+}
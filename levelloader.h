@@ -0,0 +1,85 @@
+#ifndef LEVELLOADER_H
+#define LEVELLOADER_H
+
+#include <string>
+#include <list>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class Level;
+class TextureCache;
+
+//Number of finished levels kept waiting to be installed. The oldest are discarded when more are preloaded.
+const int MAX_PRELOADED_LEVELS = 2;
+
+//Loads levels on a worker thread.
+//The worker parses the map (or reads its map cache), builds the Level and decodes its images into surfaces,
+//so the main thread only has to upload the surfaces to textures when it installs the Level.
+//Images that are already in the texture cache are not decoded at all.
+class LevelLoader
+{
+public:
+	LevelLoader(TextureCache* cache);
+
+	//Stops the worker and deletes every level that was not taken.
+	~LevelLoader();
+
+	//Queues a map to be loaded in the background. Maps that are already queued or loaded are not loaded again.
+	void request(const std::string &title);
+
+	//Returns true if a map has been requested and not taken yet.
+	bool isRequested(const std::string &title);
+
+	//Takes a map's level if it has finished loading, or returns NULL if it is still loading or was never requested.
+	//The caller takes ownership of the level. Rethrows the error if the map failed to load.
+	Level* take(const std::string &title);
+
+	//Takes a map's level, waiting for it if it is being loaded in the background.
+	//A map that was never requested is loaded on the calling thread.
+	Level* wait(const std::string &title);
+
+private:
+	enum JobState { JOB_QUEUED, JOB_LOADING, JOB_DONE };
+
+	struct Job
+	{
+		std::string title;
+		JobState state;
+		Level* level;
+		std::string error;			//set instead of level if loading failed
+		bool wanted;				//waited for by the main thread, so never discarded
+	};
+
+	//Loads a map along with the images that are not cached. Throws a runtime_error on failure.
+	Level* load(const std::string &title);
+
+	void workerLoop();
+
+	std::list<Job>::iterator findJob(const std::string &title);
+
+	//Removes a finished job and returns its level, or throws its error.
+	Level* takeJob(std::list<Job>::iterator job);
+
+	//Discards the oldest finished levels beyond MAX_PRELOADED_LEVELS that are not wanted. mMutex must be held.
+	void trimFinished();
+
+	//Jobs in request order.
+	std::list<Job> mJobs;
+
+	std::mutex mMutex;
+	std::condition_variable mWorkQueued;
+	std::condition_variable mWorkDone;
+	bool mQuit;
+
+	//only used to check which images are cached
+	TextureCache* mCache;
+
+	//Started last, once the rest of the loader is initialized.
+	std::thread mWorker;
+
+	LevelLoader(const LevelLoader&);
+	LevelLoader& operator= (const LevelLoader&);
+};
+
+#endif
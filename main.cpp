@@ -9,20 +9,30 @@
 #include "actor.h"	
 #include "gameworld.h"
 #include "GameState.h"
+#include "benchmark.h"
+#include "profiler.h"
+#include "perfoverlay.h"
 
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <vector>
+#include <cstdlib>
 
 const std::string MUSIC = "music.mp3";
 const std::string MAP = "MyMap.tmx";
 const std::string PAUSE = "pause.png";
 const std::string CHARACTER = "character.png";
 const std::string BACKGROUND = "background.jpg";
+const std::string FONT = "font.ttf";
 
-//max framerate
+//max framerate, used when frameCap is on
 const int FRAMES_PER_SECOND = 60;
 
+//Most simulation ticks run for one rendered frame. After a longer stall the simulation drops the
+//extra time instead of trying to catch up, which would make the following frames stall as well.
+const int MAX_TICKS_PER_FRAME = 5;
+
 //tile dimensions for the character
 const int CHAR_TILE_WIDTH = 26;
 const int CHAR_TILE_HEIGHT = 53;
@@ -30,10 +40,69 @@ const int CHAR_ALPHA = 0;
 
 int SDL_main(int argc, char* argv[])
 {
+	//zones are recorded on this thread, which has to be set before the level loader starts its worker
+	PROFILE_MAIN_THREAD();
+
+	//--bench runs the benchmark suite on synthetic maps without a display and exits
+	//any .tmx files given after it are timed loading as well, and the workloads are set with
+	//--sizes 64,256,1024,4096 --layers 2 --tilesets 2 --solid 0.1 --actors 1000, and --json writes the results to a file
+	//--font file.ttf also times drawing text with that font
+	//--headless runs the simulation without a display for --frames ticks, with --actors wandering Actors, and exits
+	//a .tmx file given with it is simulated instead of the default map
+	bool runBench = false;
+	bool runHeadless = false;
+	int headlessTicks = 10000;
+	int headlessActors = 100;
+	std::string map = MAP;
+	BenchSettings bench;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool isMap = arg.size() > 4 && arg.substr(arg.size() - 4) == ".tmx";
+		bool hasValue = i + 1 < argc;
+		if (arg == "--bench")
+			runBench = true;
+		else if (arg == "--headless")
+			runHeadless = true;
+		else if (arg == "--frames" && hasValue)
+			headlessTicks = atoi(argv[++i]);
+		else if (arg == "--actors" && hasValue)
+			headlessActors = bench.actors = atoi(argv[++i]);
+		else if (arg == "--layers" && hasValue)
+			bench.layers = atoi(argv[++i]);
+		else if (arg == "--tilesets" && hasValue)
+			bench.tilesets = atoi(argv[++i]);
+		else if (arg == "--solid" && hasValue)
+			bench.solidDensity = static_cast<float>(atof(argv[++i]));
+		else if (arg == "--json" && hasValue)
+			bench.json = argv[++i];
+		else if (arg == "--font" && hasValue)
+			bench.font = argv[++i];
+		else if (arg == "--sizes" && hasValue)
+		{
+			bench.sizes.clear();
+			std::istringstream sizes(argv[++i]);
+			std::string size;
+			while (std::getline(sizes, size, ','))
+				bench.sizes.push_back(atoi(size.c_str()));
+		}
+		else if (runBench && isMap)
+			bench.maps.push_back(arg);
+		else if (runHeadless && isMap)
+			map = arg;
+	}
+
+	//the benchmarks always draw with the software renderer, so that draw timings are comparable between machines
+	if (runBench)
+		runHeadless = true;
+
 	//initialize window
 	Window Win;
 	try {
-		Win.Init("The Game");
+		if (runHeadless)
+			Win.InitHeadless();
+		else
+			Win.Init("The Game");
 	}
 	catch (const std::runtime_error &e){
 		std::cout << e.what() << std::endl;
@@ -43,13 +112,18 @@ int SDL_main(int argc, char* argv[])
 	//Do not do anything to window until it has been initialized!
 
 	//Set non-border window
-	SDL_SetWindowBordered(Win.getWindow(), SDL_FALSE);
+	if (!runHeadless)
+		SDL_SetWindowBordered(Win.getWindow(), SDL_FALSE);
 
 	//Open audio
-	if (Mix_OpenAudio(22050, MIX_DEFAULT_FORMAT, 2, 4096) == -1)
-		return false;
-	Mix_Music* music = Mix_LoadMUS(MUSIC.c_str());
-	Mix_PlayMusic(music, -1);
+	Mix_Music* music = NULL;
+	if (!runHeadless)
+	{
+		if (Mix_OpenAudio(22050, MIX_DEFAULT_FORMAT, 2, 4096) == -1)
+			return false;
+		music = Mix_LoadMUS(MUSIC.c_str());
+		Mix_PlayMusic(music, -1);
+	}
 
 
 	//load player image
@@ -62,9 +136,23 @@ int SDL_main(int argc, char* argv[])
 	//open character files
 	World.openCharTiles(CHARACTER, CHAR_TILE_WIDTH, CHAR_TILE_HEIGHT, CHAR_ALPHA);
 
+	if (runBench)
+	{
+		//a failed correctness check fails the run, so that scripts and CI notice it
+		bool passed;
+		try {
+			passed = runBenchmarks(&World, bench);
+		}
+		catch (const std::runtime_error &e){
+			std::cout << e.what() << std::endl;
+			return -1;
+		}
+		return passed ? 0 : 1;
+	}
+
 	//open map (must be done after initializing window)
 	try {
-		World.openMap(MAP);
+		World.openMap(map);
 	}
 	catch (const std::runtime_error &e){
 		std::cout << e.what() << std::endl;
@@ -72,15 +160,22 @@ int SDL_main(int argc, char* argv[])
 		return -1;
 	}
 
+	if (runHeadless)
+	{
+		benchHeadless(&World, headlessTicks, headlessActors);
+		return 0;
+	}
+
 	Player* player = World.getPlayer();
 
-	//set timers for fps counter
+	//timer for the frame cap
 	Timer fps;
-	Timer fpsUpdate;
-	int frame = 0;
 	bool frameCap = true;
 
-	fpsUpdate.Start();
+	//what each frame cost, shown by the performance overlay
+	FrameHistory history;
+	FrameSample sample;
+	Timer phase;
 
 	//Create game states
 	StateManager manager(&World);
@@ -88,6 +183,12 @@ int SDL_main(int argc, char* argv[])
 	PauseState menu(&manager, pause);
 	manager.getStates()->push_back(&field);
 
+	//The simulation runs in fixed ticks of SIMULATION_STEP milliseconds. Every frame runs as many ticks
+	//as the time since the last frame holds, and drawing interpolates between the last two ticks.
+	Timer frameTime;
+	float unsimulated = 0;
+	frameTime.Start();
+
 	//Main Loop
 	bool quit = false;
 	int loadState = SAME_STATE;
@@ -95,41 +196,102 @@ int SDL_main(int argc, char* argv[])
 	while(!quit)
 	{
 		fps.Start();
-		while(SDL_PollEvent(&event))
 		{
-			//if the state was changed, load the next state
-			loadState = manager.HandleEvents(event,	quit);
-			switch (loadState)
+			PROFILE_ZONE("HandleEvents");
+			while(SDL_PollEvent(&event))
 			{
-				case FIELD_STATE:
-					manager.getStates()->back()->Pause();
-					manager.getStates()->pop_back();
-					manager.getStates()->back()->Resume();
-					break;
-				case MENU_STATE:
-					manager.getStates()->back()->Pause();
-					manager.changeState(&menu);
-					break;
-				case SAME_STATE:
-					break;
+#if SDL_VERSION_ATLEAST(2, 0, 4)
+				//render target contents are lost when this happens, so pre-rendered chunks and atlas pages have to be rebuilt
+				if (event.type == SDL_RENDER_TARGETS_RESET || event.type == SDL_RENDER_DEVICE_RESET)
+				{
+					World.getChunkCache()->clear();
+					World.getAtlas()->redraw();
+				}
+#endif
+
+				//if the state was changed, load the next state
+				loadState = manager.HandleEvents(event,	quit);
+				switch (loadState)
+				{
+					case FIELD_STATE:
+						manager.getStates()->back()->Pause();
+						manager.getStates()->pop_back();
+						manager.getStates()->back()->Resume();
+						break;
+					case MENU_STATE:
+						manager.getStates()->back()->Pause();
+						manager.changeState(&menu);
+						break;
+					case SAME_STATE:
+						break;
+				}
 			}
 		}
 
-		//update logic, reset movement-based timer
-		manager.Update();
-		manager.getWorld()->getTime()->Restart();
+		//update logic in fixed ticks
+		sample.frameTime = frameTime.RestartMilliseconds();
+		unsimulated += sample.frameTime;
+		if (unsimulated > MAX_TICKS_PER_FRAME * SIMULATION_STEP)
+			unsimulated = MAX_TICKS_PER_FRAME * SIMULATION_STEP;
+
+		phase.Start();
+		sample.ticks = 0;
+		while (unsimulated >= SIMULATION_STEP)
+		{
+			manager.Update();
+			unsimulated -= SIMULATION_STEP;
+			sample.ticks++;
+		}
+		World.setInterpolation(unsimulated / SIMULATION_STEP);
+		sample.updateTime = phase.RestartMilliseconds();
 
 		//draw objects to screen
+		Win.resetDrawCalls();
 		SDL_RenderClear(Win.getRenderer());
 		manager.Draw();
-		SDL_RenderPresent(Win.getRenderer());
+		{
+			PROFILE_ZONE("FlushBatch");
+			Win.FlushBatch();
+		}
+		sample.drawTime = phase.Milliseconds();
+		sample.drawCalls = Win.getDrawCalls();
+		sample.sprites = Win.getSpritesDrawn();
+		sample.actors = static_cast<int>(World.getActorList()->size());
+		sample.actorsDrawn = World.getActorsDrawn();
+		sample.actorsCulled = World.getActorsCulled();
+
+		//the overlay shows the frames before this one, and is left out of their timings
+		if (World.isOverlayOn())
+		{
+			PROFILE_ZONE("drawPerfOverlay");
+			drawPerfOverlay(&World, history, FONT, 1000.0 / FRAMES_PER_SECOND);
+			Win.FlushBatch();
+		}
+
+		phase.Start();
+		{
+			PROFILE_ZONE("SDL_RenderPresent");
+			SDL_RenderPresent(Win.getRenderer());
+		}
+		sample.presentTime = phase.Milliseconds();
+		history.add(sample);
+
+		//limit the frame rate; the simulation rate is unaffected
+		double frameMs = fps.Milliseconds();
+		if (frameCap && frameMs < 1000.0 / FRAMES_PER_SECOND)
+			SDL_Delay(static_cast<Uint32>(1000.0 / FRAMES_PER_SECOND - frameMs));
+
+		PROFILE_FRAME();
 	}
 
+	PROFILE_EXPORT("profile.json");
+
 	//close things
 	Mix_FreeMusic(music);
 	Mix_CloseAudio();
 
-	SDL_DestroyTexture(bg);
+	Win.ReleaseImage(bg);
+	Win.ReleaseImage(pause);
 	return 0;
 }
 
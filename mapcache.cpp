@@ -0,0 +1,440 @@
+#include "mapcache.h"
+#include "gameworld.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//Increase when the layout of the cache changes, so that old caches are recompiled.
+const Uint32 MAP_CACHE_VERSION = 1;
+
+//Written in native byte order, so that caches compiled on a machine of the other byte order are rejected.
+const Uint32 BYTE_ORDER_MARK = 0x01020304;
+
+const char MAP_CACHE_MAGIC[8] = { 'M', 'A', 'P', 'C', 'A', 'C', 'H', 'E' };
+
+//Fixed size header at the start of the cache. Every field is naturally aligned, so the struct has no padding.
+struct MapCacheHeader
+{
+	char magic[8];
+	Uint32 version;
+	Uint32 byteOrder;
+	Uint64 sourceHash;
+	Uint64 fileSize;
+	Sint32 width, height, tileWidth, tileHeight;
+
+	//Offsets from the start of the file. Layers are on cache line boundaries.
+	Uint64 metaOffset;					//Tilesets, gid table, solid gids, map properties and objects
+	Uint64 solidMapOffset;
+	Uint64 layerOffset[NUM_LAYERS];
+};
+
+MappedFile::MappedFile()
+	:mData(NULL), mSize(0),
+#if defined(_WIN32)
+	mFile(INVALID_HANDLE_VALUE), mMapping(NULL)
+#else
+	mFile(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const std::string &path)
+{
+	close();
+
+#if defined(_WIN32)
+	mFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (mFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(mFile, &size) || size.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+
+	mMapping = CreateFileMappingA(mFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	if (mMapping == NULL)
+	{
+		close();
+		return false;
+	}
+
+	mData = static_cast<char*>(MapViewOfFile(mMapping, FILE_MAP_COPY, 0, 0, 0));
+	mSize = static_cast<size_t>(size.QuadPart);
+#else
+	mFile = ::open(path.c_str(), O_RDONLY);
+	if (mFile < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(mFile, &info) != 0 || info.st_size == 0)
+	{
+		close();
+		return false;
+	}
+
+	void* data = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, mFile, 0);
+	mData = data == MAP_FAILED ? NULL : static_cast<char*>(data);
+	mSize = static_cast<size_t>(info.st_size);
+#endif
+
+	if (mData == NULL)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close()
+{
+#if defined(_WIN32)
+	if (mData != NULL)
+		UnmapViewOfFile(mData);
+	if (mMapping != NULL)
+		CloseHandle(mMapping);
+	if (mFile != INVALID_HANDLE_VALUE)
+		CloseHandle(mFile);
+	mMapping = NULL;
+	mFile = INVALID_HANDLE_VALUE;
+#else
+	if (mData != NULL)
+		munmap(mData, mSize);
+	if (mFile >= 0)
+		::close(mFile);
+	mFile = -1;
+#endif
+	mData = NULL;
+	mSize = 0;
+}
+
+//Appends values to the cache being written.
+class CacheWriter
+{
+public:
+	void writeInt(Sint32 value) { append(&value, sizeof(value)); }
+
+	void writeString(const std::string &value)
+	{
+		writeInt(static_cast<Sint32>(value.size()));
+		append(value.data(), value.size());
+	}
+
+	void writeProperties(const PropertyList &properties)
+	{
+		writeInt(static_cast<Sint32>(properties.size()));
+		for (PropertyList::const_iterator iter = properties.begin(); iter != properties.end(); iter++)
+		{
+			writeString(iter->first);
+			writeString(iter->second);
+		}
+	}
+
+	void append(const void* data, size_t size)
+	{
+		const char* bytes = static_cast<const char*>(data);
+		mBuffer.insert(mBuffer.end(), bytes, bytes + size);
+	}
+
+	//Pads the cache to a multiple of alignment bytes and returns the new size.
+	Uint64 align(size_t alignment)
+	{
+		mBuffer.resize((mBuffer.size() + alignment - 1) / alignment * alignment, 0);
+		return mBuffer.size();
+	}
+
+	std::vector<char> &getBuffer() { return mBuffer; }
+
+private:
+	std::vector<char> mBuffer;
+};
+
+//Reads values from a mapped cache. Throws a runtime_error if a value would be read past the end of the section.
+class CacheReader
+{
+public:
+	CacheReader(const char* data, size_t size)
+		:mPos(data), mEnd(data + size)
+	{
+	}
+
+	Sint32 readInt()
+	{
+		Sint32 value;
+		read(&value, sizeof(value));
+		return value;
+	}
+
+	//Reads a count, which must be positive and small enough to be plausible for the rest of the data.
+	Sint32 readCount(size_t elementSize)
+	{
+		Sint32 count = readInt();
+		if (count < 0 || static_cast<size_t>(count) > static_cast<size_t>(mEnd - mPos) / elementSize)
+			throw std::runtime_error("Corrupt map cache");
+		return count;
+	}
+
+	std::string readString()
+	{
+		Sint32 size = readCount(1);
+		std::string value(mPos, size);
+		mPos += size;
+		return value;
+	}
+
+	void readProperties(PropertyList &properties)
+	{
+		Sint32 count = readCount(2 * sizeof(Sint32));
+		for (int i = 0; i < count; i++)
+		{
+			std::string name = readString();
+			properties.push_back(std::make_pair(name, readString()));
+		}
+	}
+
+	void read(void* value, size_t size)
+	{
+		if (size > static_cast<size_t>(mEnd - mPos))
+			throw std::runtime_error("Corrupt map cache");
+		memcpy(value, mPos, size);
+		mPos += size;
+	}
+
+private:
+	const char* mPos;
+	const char* mEnd;
+};
+
+std::string getMapCachePath(const std::string &mapPath)
+{
+	return mapPath + ".cache";
+}
+
+Uint64 hashMapSource(const char* data, size_t size)
+{
+	Uint64 hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= static_cast<unsigned char>(data[i]);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+Level* readMapCache(const std::string &cachePath, Uint64 sourceHash)
+{
+	MappedFile* mapping = new MappedFile;
+	if (!mapping->open(cachePath) || mapping->getSize() < sizeof(MapCacheHeader))
+	{
+		delete mapping;
+		return NULL;
+	}
+
+	MapCacheHeader header;
+	memcpy(&header, mapping->getData(), sizeof(header));
+
+	if (memcmp(header.magic, MAP_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != MAP_CACHE_VERSION ||
+		header.byteOrder != BYTE_ORDER_MARK || header.sourceHash != sourceHash || header.fileSize != mapping->getSize() ||
+		header.width <= 0 || header.height <= 0)
+	{
+		delete mapping;
+		return NULL;
+	}
+
+	Level* level = new Level(header.width, header.height, header.tileWidth, header.tileHeight);
+
+	try
+	{
+		char* data = mapping->getData();
+		size_t size = mapping->getSize();
+		if (header.metaOffset > size || header.solidMapOffset > size)
+			throw std::runtime_error("Corrupt map cache");
+
+		CacheReader meta(data + header.metaOffset, size - static_cast<size_t>(header.metaOffset));
+
+		//Tilesets, already ordered by first gid. Their images are loaded when the level is installed.
+		Sint32 numTilesets = meta.readCount(9 * sizeof(Sint32));
+		for (int i = 0; i < numTilesets; i++)
+		{
+			Sint32 values[8];
+			meta.read(values, sizeof(values));
+
+			Tileset* tileset = new Tileset(NULL, values[0], values[1], values[2], values[3], values[4], values[5]);
+			tileset->margin = values[6];
+			tileset->spacing = values[7];
+			level->getTileSet()->push_back(tileset);
+			tileset->source = meta.readString();
+		}
+
+		//gid lookup table
+		Sint32 numGids = meta.readCount(sizeof(GidEntry));
+		level->getGidTable()->resize(numGids);
+		if (numGids > 0)
+			meta.read(&(*level->getGidTable())[0], numGids * sizeof(GidEntry));
+
+		for (std::vector<GidEntry>::iterator iter = level->getGidTable()->begin(); iter != level->getGidTable()->end(); iter++)
+		{
+			if (iter->tileset >= numTilesets)
+				throw std::runtime_error("Corrupt map cache");
+		}
+
+		//solid gids, from which the gid solidity table is rebuilt
+		Sint32 numSolidGids = meta.readCount(sizeof(Sint32));
+		for (int i = 0; i < numSolidGids; i++)
+			level->getSolidGid()->insert(meta.readInt());
+		level->buildSolidTable();
+
+		//map properties and objects
+		meta.readProperties(*level->getProperties());
+		level->buildParallaxLayers();
+
+		Sint32 numObjects = meta.readCount(8 * sizeof(Sint32));
+		for (int i = 0; i < numObjects; i++)
+		{
+			MapObject object;
+			object.group = meta.readString();
+			object.name = meta.readString();
+			object.type = meta.readString();
+			meta.read(&object.box, sizeof(object.box));
+			meta.readProperties(object.properties);
+			level->getObjects()->push_back(object);
+		}
+
+		//solid bitmap
+		CacheReader solid(data + header.solidMapOffset, size - static_cast<size_t>(header.solidMapOffset));
+		Sint32 numSolidWords = solid.readCount(sizeof(Uint32));
+		if (numSolidWords != (header.width * header.height + 31) / 32)
+			throw std::runtime_error("Corrupt map cache");
+		level->getSolidMap()->resize(numSolidWords);
+		solid.read(&(*level->getSolidMap())[0], numSolidWords * sizeof(Uint32));
+
+		//tile layers are used where they are, without copying
+		Uint64 layerSize = static_cast<Uint64>(header.width) * header.height * sizeof(int);
+		for (int i = 0; i < NUM_LAYERS; i++)
+		{
+			if (header.layerOffset[i] % CACHE_LINE_SIZE != 0 || header.layerOffset[i] + layerSize > size)
+				throw std::runtime_error("Corrupt map cache");
+
+			int* gids = reinterpret_cast<int*>(data + header.layerOffset[i]);
+			level->setLayer(i, new TileLayer(header.width, header.height, gids));
+		}
+	}
+	catch (const std::runtime_error&)
+	{
+		delete level;
+		delete mapping;
+		return NULL;
+	}
+
+	level->setMapping(mapping);
+	return level;
+}
+
+bool writeMapCache(const std::string &cachePath, Uint64 sourceHash, Level* level)
+{
+	MapCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MAP_CACHE_MAGIC, sizeof(header.magic));
+	header.version = MAP_CACHE_VERSION;
+	header.byteOrder = BYTE_ORDER_MARK;
+	header.sourceHash = sourceHash;
+	header.width = level->getWidth();
+	header.height = level->getHeight();
+	header.tileWidth = level->getTileWidth();
+	header.tileHeight = level->getTileHeight();
+
+	//the header is filled in last, once the offsets are known
+	CacheWriter writer;
+	writer.append(&header, sizeof(header));
+
+	header.metaOffset = writer.align(sizeof(Sint32));
+
+	std::vector<Tileset*>* tilesets = level->getTileSet();
+	writer.writeInt(static_cast<Sint32>(tilesets->size()));
+	for (std::vector<Tileset*>::iterator iter = tilesets->begin(); iter != tilesets->end(); iter++)
+	{
+		Tileset* tileset = *iter;
+		Sint32 values[8] = { tileset->firstGid, tileset->w, tileset->h, tileset->tileW, tileset->tileH, tileset->alpha, tileset->margin, tileset->spacing };
+		writer.append(values, sizeof(values));
+		writer.writeString(tileset->source);
+	}
+
+	std::vector<GidEntry>* gidTable = level->getGidTable();
+	writer.writeInt(static_cast<Sint32>(gidTable->size()));
+	if (!gidTable->empty())
+		writer.append(&(*gidTable)[0], gidTable->size() * sizeof(GidEntry));
+
+	std::set<int>* solidGid = level->getSolidGid();
+	writer.writeInt(static_cast<Sint32>(solidGid->size()));
+	for (std::set<int>::iterator iter = solidGid->begin(); iter != solidGid->end(); iter++)
+		writer.writeInt(*iter);
+
+	writer.writeProperties(*level->getProperties());
+
+	std::vector<MapObject>* objects = level->getObjects();
+	writer.writeInt(static_cast<Sint32>(objects->size()));
+	for (std::vector<MapObject>::iterator iter = objects->begin(); iter != objects->end(); iter++)
+	{
+		writer.writeString(iter->group);
+		writer.writeString(iter->name);
+		writer.writeString(iter->type);
+		writer.append(&iter->box, sizeof(iter->box));
+		writer.writeProperties(iter->properties);
+	}
+
+	header.solidMapOffset = writer.align(sizeof(Uint32));
+	std::vector<Uint32>* solidMap = level->getSolidMap();
+	writer.writeInt(static_cast<Sint32>(solidMap->size()));
+	if (!solidMap->empty())
+		writer.append(&(*solidMap)[0], solidMap->size() * sizeof(Uint32));
+
+	for (int i = 0; i < NUM_LAYERS; i++)
+	{
+		TileLayer* layer = level->getLayer(i);
+		header.layerOffset[i] = writer.align(CACHE_LINE_SIZE);
+		writer.append(layer->data(), layer->getSize() * sizeof(int));
+	}
+
+	header.fileSize = writer.getBuffer().size();
+	memcpy(&writer.getBuffer()[0], &header, sizeof(header));
+
+	//The cache is written to a temporary file and then moved into place, because an open Level may still have the old cache mapped.
+	//Truncating a mapped file would invalidate its pages; replacing it leaves the old mapping intact.
+	std::string tempPath = cachePath + ".tmp";
+	{
+		std::ofstream file(tempPath.c_str(), std::ios::binary | std::ios::trunc);
+		if (!file)
+			return false;
+
+		file.write(&writer.getBuffer()[0], writer.getBuffer().size());
+		if (!file.good())
+			return false;
+	}
+
+	std::remove(cachePath.c_str());
+	if (std::rename(tempPath.c_str(), cachePath.c_str()) != 0)
+	{
+		std::remove(tempPath.c_str());
+		return false;
+	}
+	return true;
+}
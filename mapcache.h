@@ -0,0 +1,65 @@
+#ifndef MAPCACHE_H
+#define MAPCACHE_H
+
+#include <string>
+
+#if defined(_MSC_VER)
+#include <SDL.h>
+#elif defined(__clang__)
+#include <SDL2/SDL.h>
+#else
+#include <SDL2/SDL.h>
+#endif
+
+class Level;
+
+//A file mapped into memory.
+//Pages are mapped copy-on-write, so the contents can be changed in memory without changing the file.
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	//Maps a file into memory. Returns false if the file cannot be opened or is empty.
+	bool open(const std::string &path);
+	void close();
+
+	char* getData() { return mData; }
+	size_t getSize() const { return mSize; }
+
+private:
+	//Mappings are not copied.
+	MappedFile(const MappedFile&);
+	MappedFile& operator= (const MappedFile&);
+
+	char* mData;
+	size_t mSize;
+
+#if defined(_WIN32)
+	void* mFile;			//file HANDLE
+	void* mMapping;			//file mapping HANDLE
+#else
+	int mFile;				//file descriptor
+#endif
+};
+
+//Compiled maps are cached next to their .tmx file in a binary format holding the map header, the Tilesets,
+//the gid lookup table, the solid bitmap, the tile layers and the map objects.
+//The tile layers are stored uncompressed on cache line boundaries, so a Level can use them straight from the mapped file.
+
+//Returns the file name of the map cache of a .tmx file.
+std::string getMapCachePath(const std::string &mapPath);
+
+//Hashes the text of a .tmx file (64 bit FNV-1a), to tell whether its map cache is up to date.
+Uint64 hashMapSource(const char* data, size_t size);
+
+//Loads a Level from a map cache, if the cache exists and was compiled from a .tmx file with the given hash.
+//The Level's tile layers point straight into the mapped cache file, which stays mapped until the Level is deleted.
+//Returns NULL if the cache is missing, out of date or corrupt.
+Level* readMapCache(const std::string &cachePath, Uint64 sourceHash);
+
+//Writes the map cache of a Level compiled from a .tmx file with the given hash. Returns false if it could not be written.
+bool writeMapCache(const std::string &cachePath, Uint64 sourceHash, Level* level);
+
+#endif
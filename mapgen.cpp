@@ -0,0 +1,144 @@
+#include "mapgen.h"
+#include "base64.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+//Names of the tile layers, in the order they are generated.
+static const char* LAYER_NAMES[] = { "background", "background2", "overlayer", "overlayer2" };
+static const int MAX_LAYERS = 4;
+
+//Fraction of tiles that are not empty in each layer after the background.
+static const float DECORATION_DENSITY = 0.1f;
+
+//The playerSpawn object is placed in a free area of this many tiles in the top left corner.
+static const int SPAWN_AREA = 4;
+
+//xorshift32, so that maps are the same on every platform, unlike with rand().
+class MapRandom
+{
+public:
+	MapRandom(unsigned seed)
+		:mState(seed != 0 ? seed : 1)
+	{
+	}
+
+	unsigned next()
+	{
+		mState ^= mState << 13;
+		mState ^= mState >> 17;
+		mState ^= mState << 5;
+		return mState;
+	}
+
+	//Returns a number from 0 up to but not including range.
+	int below(int range) { return static_cast<int>(next() % static_cast<unsigned>(range)); }
+
+	//Returns true with the given probability.
+	bool chance(float probability) { return (next() & 0xFFFFFF) < probability * 0x1000000; }
+
+private:
+	unsigned mState;
+};
+
+//Base64 encodes tiles as little endian 32 bit gids, as in TMX files.
+static std::string encodeTiles(const std::vector<int> &tiles)
+{
+	std::vector<unsigned char> bytes(tiles.size() * 4);
+	for (size_t i = 0; i < tiles.size(); i++)
+	{
+		unsigned gid = static_cast<unsigned>(tiles[i]);
+		bytes[i * 4] = static_cast<unsigned char>(gid);
+		bytes[i * 4 + 1] = static_cast<unsigned char>(gid >> 8);
+		bytes[i * 4 + 2] = static_cast<unsigned char>(gid >> 16);
+		bytes[i * 4 + 3] = static_cast<unsigned char>(gid >> 24);
+	}
+	return base64_encode(&bytes[0], static_cast<unsigned int>(bytes.size()));
+}
+
+std::string generateMap(const MapGenSettings &settings)
+{
+	int width = std::max(settings.width, SPAWN_AREA + 2);
+	int height = std::max(settings.height, SPAWN_AREA + 2);
+	int layers = std::min(std::max(settings.layers, 1), MAX_LAYERS);
+	int tilesets = std::max(settings.tilesets, 1);
+
+	//Tile 0 of every tileset is solid, the others are not.
+	int tilesPerRow = GENERATED_TILESET_SIZE / GENERATED_TILE_SIZE;
+	int tilesPerTileset = tilesPerRow * tilesPerRow;
+
+	MapRandom random(settings.seed);
+	std::ostringstream tmx;
+
+	tmx << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+	tmx << "<map version=\"1.0\" orientation=\"orthogonal\" width=\"" << width << "\" height=\"" << height
+		<< "\" tilewidth=\"" << GENERATED_TILE_SIZE << "\" tileheight=\"" << GENERATED_TILE_SIZE << "\">\n";
+
+	for (int i = 0; i < tilesets; i++)
+	{
+		tmx << " <tileset firstgid=\"" << 1 + i * tilesPerTileset << "\" name=\"synthetic" << i
+			<< "\" tilewidth=\"" << GENERATED_TILE_SIZE << "\" tileheight=\"" << GENERATED_TILE_SIZE << "\">\n";
+		tmx << "  <image source=\"synthetic" << i << ".png\" width=\"" << GENERATED_TILESET_SIZE
+			<< "\" height=\"" << GENERATED_TILESET_SIZE << "\"/>\n";
+		tmx << "  <tile id=\"0\">\n   <properties>\n    <property name=\"solid\" value=\"1\"/>\n   </properties>\n  </tile>\n";
+		tmx << " </tileset>\n";
+	}
+
+	std::vector<int> tiles(width * height);
+	for (int layer = 0; layer < layers; layer++)
+	{
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				int firstGid = 1 + random.below(tilesets) * tilesPerTileset;
+				int solidGid = firstGid;
+				int passableGid = firstGid + 1 + random.below(tilesPerTileset - 1);
+
+				bool border = x == 0 || y == 0 || x == width - 1 || y == height - 1;
+				bool spawnArea = x <= SPAWN_AREA && y <= SPAWN_AREA;
+
+				int gid = 0;
+				if (layer == 0)
+				{
+					if (border)
+						gid = solidGid;
+					else if (!spawnArea && random.chance(settings.solidDensity))
+						gid = solidGid;
+					else
+						gid = passableGid;
+				}
+				else if (random.chance(DECORATION_DENSITY))
+					gid = passableGid;
+
+				tiles[y * width + x] = gid;
+			}
+		}
+
+		tmx << " <layer name=\"" << LAYER_NAMES[layer] << "\" width=\"" << width << "\" height=\"" << height << "\">\n";
+		tmx << "  <data encoding=\"base64\">\n   " << encodeTiles(tiles) << "\n  </data>\n";
+		tmx << " </layer>\n";
+	}
+
+	tmx << " <objectgroup name=\"playerSpawn\">\n";
+	tmx << "  <object x=\"" << GENERATED_TILE_SIZE << "\" y=\"" << GENERATED_TILE_SIZE << "\" width=\"" << GENERATED_TILE_SIZE
+		<< "\" height=\"" << GENERATED_TILE_SIZE << "\"/>\n";
+	tmx << " </objectgroup>\n";
+	tmx << "</map>\n";
+
+	return tmx.str();
+}
+
+void writeGeneratedMap(const std::string &file, const MapGenSettings &settings)
+{
+	std::ofstream out(file.c_str(), std::ios::binary);
+	if (!out)
+		throw std::runtime_error("Failed to write map " + file);
+
+	out << generateMap(settings);
+	if (!out)
+		throw std::runtime_error("Failed to write map " + file);
+}
@@ -0,0 +1,46 @@
+#ifndef MAPGEN_H
+#define MAPGEN_H
+
+#include <string>
+
+//Synthetic TMX maps for the benchmarks, so that every run measures the same workload without depending on the game's maps.
+//Maps follow the format read by parseMap(). Tileset images are named synthetic0.png, synthetic1.png and so on,
+//and do not exist, so the maps are meant to be opened with placeholder textures, as in headless mode.
+
+//Tile size of generated maps, in pixels.
+const int GENERATED_TILE_SIZE = 32;
+
+//Size of a generated tileset image, in pixels.
+const int GENERATED_TILESET_SIZE = 256;
+
+struct MapGenSettings
+{
+	MapGenSettings()
+		:width(256), height(256), layers(2), tilesets(2), solidDensity(0.1f), seed(1)
+	{
+	}
+
+	//Map size in tiles.
+	int width, height;
+
+	//Number of tile layers, from 1 to NUM_LAYERS: background, background2, overlayer and overlayer2, in that order.
+	int layers;
+
+	//Number of tilesets. Tiles are drawn from all of them.
+	int tilesets;
+
+	//Fraction of background tiles that are solid, from 0 to 1. The border of the map is always solid.
+	float solidDensity;
+
+	//The same settings and seed always generate the same map.
+	unsigned seed;
+};
+
+//Generates a map with random tiles and a playerSpawn object on a free area.
+//@return The TMX text of the map
+std::string generateMap(const MapGenSettings &settings);
+
+//Generates a map and writes it to a file. Throws a runtime_error if the file cannot be written.
+void writeGeneratedMap(const std::string &file, const MapGenSettings &settings);
+
+#endif
@@ -0,0 +1,301 @@
+#include "maploader.h"
+#include "gameworld.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+//Appends every property of a properties node to a PropertyList. The node may be NULL.
+static void readProperties(rapidxml::xml_node<> *properties, PropertyList &list)
+{
+	if (properties == NULL)
+		return;
+
+	for (rapidxml::xml_node<> *property = properties->first_node("property"); property != NULL; property = property->next_sibling("property"))
+	{
+		rapidxml::xml_attribute<> *name = property->first_attribute("name");
+		rapidxml::xml_attribute<> *value = property->first_attribute("value");
+		if (name != NULL)
+			list.push_back(std::make_pair(std::string(name->value()), std::string(value != NULL ? value->value() : "")));
+	}
+}
+
+//Returns an integer attribute of a node, or fallback if the node does not have it.
+static int intAttribute(rapidxml::xml_node<> *node, const char* name, int fallback = 0)
+{
+	rapidxml::xml_attribute<> *attribute = node->first_attribute(name);
+	return attribute != NULL ? atoi(attribute->value()) : fallback;
+}
+
+Level* loadLevel(const std::string &title)
+{
+	//reads in file, converts to string, and passes it to the parser
+	std::ifstream mapFile(title.c_str(), std::ios::binary);
+	if (!mapFile)
+		throw std::runtime_error("Failed to open map " + title);
+
+	std::ostringstream temp;
+	temp << mapFile.rdbuf();
+	std::string map = temp.str();
+	mapFile.close();
+
+	//a cache compiled from this exact text can be used instead of parsing it
+	Uint64 sourceHash = hashMapSource(map.data(), map.size());
+	std::string cachePath = getMapCachePath(title);
+
+	Level* level = readMapCache(cachePath, sourceHash);
+	if (level != NULL)
+	{
+		printf("Loaded %s from its map cache.\n", title.c_str());
+		return level;
+	}
+
+	level = parseMap(&map[0]);
+
+	//the cache is only an optimization, so a map in a read only directory is simply parsed every time
+	if (!writeMapCache(cachePath, sourceHash, level))
+		printf("Could not write the map cache %s.\n", cachePath.c_str());
+
+	return level;
+}
+
+//Returns true if an image still has to be decoded.
+static bool needsDecoding(const std::string &file, const TextureCache* cache)
+{
+	return cache == NULL || !cache->contains(file);
+}
+
+//Decodes an image, or returns NULL if it cannot be loaded.
+static SDL_Surface* decodeImage(const std::string &file)
+{
+	try
+	{
+		return Window::LoadSurface(file);
+	}
+	catch (const std::runtime_error&)
+	{
+		return NULL;
+	}
+}
+
+void loadLevelImages(Level* level, const TextureCache* cache)
+{
+	//An image that cannot be decoded here is left for GameWorld::installLevel() to load,
+	//which reports the error or, when the texture cache uses placeholders, substitutes one.
+	for (std::vector<Tileset*>::iterator iter = level->getTileSet()->begin(); iter != level->getTileSet()->end(); iter++)
+	{
+		if ((*iter)->pixels == NULL && needsDecoding((*iter)->source, cache))
+			(*iter)->pixels = decodeImage((*iter)->source);
+	}
+
+	for (std::vector<ParallaxLayer>::iterator iter = level->getParallaxLayers()->begin(); iter != level->getParallaxLayers()->end(); iter++)
+	{
+		if (iter->pixels == NULL && needsDecoding(iter->source, cache))
+			iter->pixels = decodeImage(iter->source);
+	}
+}
+
+Level* parseMap(char* text)
+{
+	//------------------------------------------FORMAT---------------------------------------------------------------//
+	//- tiles that are solid will have property name = "solid" and either value "0" or "1" indicating soldness.
+	//- one image per tileset.
+	//- any number of tilesets may be used; each gid is drawn from the tileset that owns it.
+	//- an object layer "playerSpawn" with a rectangle indicating spawn location.
+	//- an object layer "playerExit" with rectangles leading to other maps. Each has the property "map" with the map file name,
+	//  and optionally "spawn" with the index of the playerSpawn object to arrive at. Spawn points must not overlap exits.
+	//- to make player not go off edges of map, add invisible solid tiles around border.
+	//- For parallax background: In map properties, add the property "parallaxBg" and the image file name as its value.
+	//  More layers go in "parallaxBg2" up to "parallaxBg8", each in front of the previous one. The property "parallaxBgFactor"
+	//  (or "parallaxBg2Factor" and so on) sets how fast a layer scrolls compared to the level, as "f" for both axes or "x,y",
+	//  0.5 by default.
+	//- tile layer data is base64 encoded, either uncompressed or compressed with zlib, gzip or zstd.
+
+	//Layer format:
+
+	//over layer 2
+	//over layer, with non-solid tiles indicating things above actors
+	//actor layer
+	//background layer 2, with solid/passable tiles for objects with transparency
+	//background layer 1, with solid/passable tiles
+
+	//Character sprite sheets are stored in a single image opened by openCharTiles().
+	//		  step1    stand    step2
+	//down
+	//left
+	//right
+	//up
+	//topleft
+	//botleft
+	//topright
+	//botright
+
+	//Look at the Tiled website to see the format of the TMX XML tree.
+	//-------------------------------------------------------------------------------------------------------------------//
+
+
+	//the xml_document parses the text and converts it to a DOM tree
+	rapidxml::xml_document<> mapData;
+	mapData.parse<0>(text);
+
+	//reads the first child of the xml root node, which is the map node
+	//obtains map/tile dimensions and creates the tile layers
+	rapidxml::xml_node<> *mapProperties = mapData.first_node("map");
+	if (mapProperties == NULL)
+		throw std::runtime_error("Map has no map node");
+
+	int levelWidth = intAttribute(mapProperties, "width");
+	int levelHeight = intAttribute(mapProperties, "height");
+	int tileWidth = intAttribute(mapProperties, "tilewidth");
+	int tileHeight = intAttribute(mapProperties, "tileheight");
+	if (levelWidth <= 0 || levelHeight <= 0)
+		throw std::runtime_error("Map has no size");
+
+	Level* level = new Level(levelWidth, levelHeight, tileWidth, tileHeight);
+	level->createLayers();
+
+	try
+	{
+		//Going through the DOM tree
+		for (rapidxml::xml_node<> *mapInfo = mapProperties->first_node(); mapInfo != NULL; mapInfo = mapInfo->next_sibling())
+		{
+			std::string nodeName = mapInfo->name();
+
+			//tilesets
+			if (nodeName == "tileset")
+			{
+				printf("Here is a tileset.\n");
+
+				//the image node contains the source location of the tileset image,
+				//which is loaded when the level is installed
+				rapidxml::xml_node<> *image = mapInfo->first_node("image");
+				if (image == NULL || image->first_attribute("source") == NULL)
+					throw std::runtime_error("Tileset has no image");
+
+				//Obtains the first global ID.
+				//Width and height are the size of the image in pixels.
+				int fgid = intAttribute(mapInfo, "firstgid");
+				int width = intAttribute(image, "width");
+				int height = intAttribute(image, "height");
+				int tileWidth = intAttribute(mapInfo, "tilewidth");
+				int tileHeight = intAttribute(mapInfo, "tileheight");
+				int alpha = intAttribute(image, "trans");
+
+				Tileset* newTileset = new Tileset(NULL, fgid, width, height, tileWidth, tileHeight, alpha);
+				newTileset->source = image->first_attribute("source")->value();
+
+				//margin and spacing are optional
+				newTileset->margin = intAttribute(mapInfo, "margin");
+				newTileset->spacing = intAttribute(mapInfo, "spacing");
+
+				level->getTileSet()->push_back(newTileset);
+
+				//Searches the tile properties to find which tiles are solid.
+				for (rapidxml::xml_node<> *tile = mapInfo->first_node("tile"); tile != NULL; tile = tile->next_sibling("tile"))
+				{
+					PropertyList tileProperties;
+					readProperties(tile->first_node("properties"), tileProperties);
+
+					//Remember to add the first global id to the relative Tile id.
+					if (atoi(findProperty(tileProperties, "solid").c_str()))
+						level->getSolidGid()->insert(intAttribute(tile, "id") + fgid);
+				}
+			}
+
+
+			//layers
+			else if (nodeName == "layer")
+			{
+				printf("Here is a layer.\n");
+
+				//finding the destination layer once, rather than for every tile
+				TileLayer* layer = NULL;
+				std::string layerName = mapInfo->first_attribute("name")->value();
+				if (layerName == "background")
+					layer = level->getLayer(LAYER_BACKGROUND);
+				else if (layerName == "background2")
+					layer = level->getLayer(LAYER_BACKGROUND2);
+				else if (layerName == "overlayer")
+					layer = level->getLayer(LAYER_OVERLAYER);
+				else if (layerName == "overlayer2")
+					layer = level->getLayer(LAYER_OVERLAYER2);
+
+				if (layer == NULL)
+					continue;
+
+				//decodes the base64 encoded, optionally compressed data straight into the layer
+				//decoded data is little endian byte order, and tiles are stored row by row, which is the order of the layer
+				rapidxml::xml_node<> *data = mapInfo->first_node("data");
+				if (data == NULL)
+					throw std::runtime_error("Layer " + layerName + " has no data");
+
+				std::string encoding = data->first_attribute("encoding") != NULL ? data->first_attribute("encoding")->value() : "";
+				std::string compression = data->first_attribute("compression") != NULL ? data->first_attribute("compression")->value() : "";
+
+				unsigned char* gidBytes = reinterpret_cast<unsigned char*>(layer->data());
+				size_t decodedSize = decodeLayerData(data->value(), data->value_size(), encoding, compression, gidBytes, layer->getSize() * sizeof(int));
+				if (decodedSize != layer->getSize() * sizeof(int))
+					throw std::runtime_error("Layer " + layerName + " has the wrong amount of tile data");
+
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+				int* gids = layer->data();
+				for (int tileNum = 0; tileNum < layer->getSize(); tileNum++)
+					gids[tileNum] = SDL_SwapLE32(gids[tileNum]);
+#endif
+			}
+
+
+			//object groups
+			//objects are kept in file order, so the nth object of a group is the nth spawn point, exit and so on
+			else if (nodeName == "objectgroup")
+			{
+				printf("Here is a object group.\n");
+				std::string objectGroupName = mapInfo->first_attribute("name")->value();
+
+				for (rapidxml::xml_node<> *object = mapInfo->first_node("object"); object != NULL; object = object->next_sibling("object"))
+				{
+					MapObject newObject;
+					newObject.group = objectGroupName;
+					newObject.name = object->first_attribute("name") != NULL ? object->first_attribute("name")->value() : "";
+					newObject.type = object->first_attribute("type") != NULL ? object->first_attribute("type")->value() : "";
+					newObject.box.x = intAttribute(object, "x");
+					newObject.box.y = intAttribute(object, "y");
+					newObject.box.w = intAttribute(object, "width");
+					newObject.box.h = intAttribute(object, "height");
+					readProperties(object->first_node("properties"), newObject.properties);
+
+					level->getObjects()->push_back(newObject);
+				}
+			}
+
+			//image layers
+			else if (nodeName == "imagelayer")
+			{
+				printf("Here is an image layer.\n");
+			}
+
+			//map properties, such as the parallax background
+			else if (nodeName == "properties")
+			{
+				printf("Here is a properties layer.\n");
+				readProperties(mapInfo, *level->getProperties());
+			}
+
+			else
+				;
+		}
+
+		//precomputing the tileset and clip of every gid, and the solidity of every tile, now that the tilesets and layers are read
+		level->buildGidTable();
+		level->buildSolidMap();
+		level->buildParallaxLayers();
+	}
+	catch (...)
+	{
+		delete level;
+		throw;
+	}
+
+	mapData.clear();
+	return level;
+}
@@ -0,0 +1,23 @@
+#ifndef MAPLOADER_H
+#define MAPLOADER_H
+
+#include <string>
+
+class Level;
+class TextureCache;
+
+//Loads a .tmx map into a new Level, without loading any images, so that the Level can be installed later by GameWorld.
+//The map cache next to the map is used when it is up to date; otherwise the map is parsed and its cache is rewritten.
+//Throws a runtime_error if the map cannot be read.
+Level* loadLevel(const std::string &title);
+
+//Parses the text of a .tmx map into a new Level. The text is modified in place by the parser.
+//Tileset and parallax images are only recorded by file name. Throws a runtime_error if the map is malformed.
+Level* parseMap(char* text);
+
+//Decodes the tileset and parallax images of a Level into surfaces, ready to be uploaded when the Level is installed.
+//Images already in the texture cache are skipped, since installing the Level reuses their textures.
+//This does not use the renderer, so it may be run on any thread. Images that cannot be decoded are left to GameWorld::installLevel().
+void loadLevelImages(Level* level, const TextureCache* cache = NULL);
+
+#endif
@@ -0,0 +1,99 @@
+#include "perfoverlay.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+//Layout of the overlay, in screen pixels.
+const int OVERLAY_MARGIN = 8;
+const int OVERLAY_PADDING = 6;
+const int OVERLAY_BAR_WIDTH = 6;
+const int OVERLAY_BAR_GAP = 1;
+const int OVERLAY_GRAPH_HEIGHT = 60;
+
+void drawPerfOverlay(GameWorld* world, const FrameHistory &history, const std::string &font, double frameBudget)
+{
+	Window* window = world->getWin();
+	if (history.size() == 0)
+		return;
+
+	//averages over the latest frames, and the longest frame of the history
+	int averaged = std::min(history.size(), OVERLAY_AVERAGE_FRAMES);
+	double frameTime = 0, updateTime = 0, drawTime = 0, presentTime = 0, longest = 0;
+	for (int i = history.size() - averaged; i < history.size(); i++)
+	{
+		frameTime += history.at(i).frameTime;
+		updateTime += history.at(i).updateTime;
+		drawTime += history.at(i).drawTime;
+		presentTime += history.at(i).presentTime;
+	}
+	frameTime /= averaged;
+	updateTime /= averaged;
+	drawTime /= averaged;
+	presentTime /= averaged;
+
+	int counts[OVERLAY_BUCKETS] = { 0 };
+	for (int i = 0; i < history.size(); i++)
+	{
+		double time = history.at(i).frameTime;
+		longest = std::max(longest, time);
+		int bucket = std::min(static_cast<int>(time), OVERLAY_BUCKETS - 1);
+		counts[std::max(bucket, 0)]++;
+	}
+
+	const FrameSample &latest = history.at(history.size() - 1);
+
+	std::ostringstream text;
+	text << std::fixed << std::setprecision(1);
+	text << (frameTime > 0 ? 1000.0 / frameTime : 0.0) << " fps  " << frameTime << " ms  longest " << longest << " ms\n";
+	text << "update " << updateTime << "  draw " << drawTime << "  present " << presentTime << " ms\n";
+	text << "draw calls " << latest.drawCalls << "  sprites " << latest.sprites << "  ticks " << latest.ticks << "\n";
+	text << "actors " << latest.actors << "  drawn " << latest.actorsDrawn << "  culled " << latest.actorsCulled << "\n";
+	text << "textures " << world->getTextureMemory() / (1024.0 * 1024.0) << " MB";
+
+	//the overlay still shows the histogram without its font
+	bool hasFont = window->getGlyphCache()->getFont(font, OVERLAY_FONT_SIZE) != NULL;
+	SDL_Point textSize = { 0, 0 };
+	if (hasFont)
+		textSize = window->MeasureString(text.str(), font, OVERLAY_FONT_SIZE);
+
+	int graphWidth = OVERLAY_BUCKETS * (OVERLAY_BAR_WIDTH + OVERLAY_BAR_GAP) - OVERLAY_BAR_GAP;
+	int textY = OVERLAY_MARGIN + OVERLAY_PADDING;
+	int graphY = textY + (hasFont ? textSize.y + OVERLAY_PADDING : 0);
+
+	SDL_Rect panel = { OVERLAY_MARGIN, OVERLAY_MARGIN, std::max(textSize.x, graphWidth) + 2 * OVERLAY_PADDING,
+		graphY + OVERLAY_GRAPH_HEIGHT + OVERLAY_PADDING - OVERLAY_MARGIN };
+	SDL_Color shade = { 0, 0, 0, 160 };
+	window->FillRects(&panel, 1, shade);
+
+	if (hasFont)
+	{
+		SDL_Color white = { 255, 255, 255, 255 };
+		window->DrawString(text.str(), font, OVERLAY_FONT_SIZE, white, OVERLAY_MARGIN + OVERLAY_PADDING, textY);
+	}
+
+	//bars are scaled to the most common frame time, and split by color into two calls
+	int tallest = *std::max_element(counts, counts + OVERLAY_BUCKETS);
+	SDL_Rect fast[OVERLAY_BUCKETS], slow[OVERLAY_BUCKETS];
+	int fastCount = 0, slowCount = 0;
+	for (int bucket = 0; bucket < OVERLAY_BUCKETS; bucket++)
+	{
+		if (counts[bucket] == 0)
+			continue;
+
+		int height = std::max(1, counts[bucket] * OVERLAY_GRAPH_HEIGHT / tallest);
+		SDL_Rect bar = { OVERLAY_MARGIN + OVERLAY_PADDING + bucket * (OVERLAY_BAR_WIDTH + OVERLAY_BAR_GAP),
+			graphY + OVERLAY_GRAPH_HEIGHT - height, OVERLAY_BAR_WIDTH, height };
+
+		//a bucket holds frames up to a millisecond longer than its index, and is green if any of them can be within budget
+		if (bucket < frameBudget)
+			fast[fastCount++] = bar;
+		else
+			slow[slowCount++] = bar;
+	}
+
+	SDL_Color green = { 64, 220, 64, 255 };
+	SDL_Color red = { 230, 64, 64, 255 };
+	window->FillRects(fast, fastCount, green);
+	window->FillRects(slow, slowCount, red);
+}
@@ -0,0 +1,28 @@
+#ifndef PERFOVERLAY_H
+#define PERFOVERLAY_H
+
+#include <string>
+#include "gameworld.h"
+#include "framestats.h"
+
+//Point size of the overlay's text.
+const int OVERLAY_FONT_SIZE = 14;
+
+//Number of frames the frame rate and phase times are averaged over.
+const int OVERLAY_AVERAGE_FRAMES = 30;
+
+//The frame time histogram has one bar per millisecond. Frames longer than the last bar are counted in it.
+const int OVERLAY_BUCKETS = 40;
+
+//Draws the performance overlay in the top left corner of the window: the frame rate, the average time of each phase
+//of a frame, draw calls, Actors simulated, drawn and culled, texture memory, and a histogram of the frame times of the history.
+//Bars of frames within the frame budget are green, and the rest red.
+//Everything is drawn with a few renderer calls, and only the history and a few getters are read, so the overlay barely
+//changes what it measures. If the font cannot be opened the text is left out.
+//@param world The world to read the Actor counts and texture memory of
+//@param history The frames to show, the latest last
+//@param font The font to draw the text with
+//@param frameBudget The time a frame may take in milliseconds, such as 1000 / 60
+void drawPerfOverlay(GameWorld* world, const FrameHistory &history, const std::string &font, double frameBudget);
+
+#endif
@@ -0,0 +1,132 @@
+#include "profiler.h"
+
+#ifdef MAPEXPLORER_PROFILE
+
+#include <fstream>
+
+//Zones expected per frame. Frames with more zones grow their buffer once, after which recording does not allocate.
+const int PROFILE_EVENTS_PER_FRAME = 256;
+const int PROFILE_COUNTERS_PER_FRAME = 16;
+
+std::vector<ProfileFrame> Profiler::sFrames;
+int Profiler::sCurrent = 0;
+int Profiler::sRecorded = 0;
+int Profiler::sDepth = 0;
+std::thread::id Profiler::sThread;
+
+int Profiler::enterZone()
+{
+	if (!isProfilerThread())
+		return 0;
+	return sDepth++;
+}
+
+void Profiler::leaveZone()
+{
+	if (isProfilerThread())
+		sDepth--;
+}
+
+bool Profiler::isProfilerThread()
+{
+	//nothing is recorded until PROFILE_MAIN_THREAD() sets the owner
+	return sThread != std::thread::id() && sThread == std::this_thread::get_id();
+}
+
+void Profiler::record(const char* name, Uint64 start, Uint64 end, int depth)
+{
+	if (!isProfilerThread())
+		return;
+
+	if (sFrames.empty())
+		endFrame();
+
+	ProfileEvent event = { name, start, end, depth };
+	sFrames[sCurrent].events.push_back(event);
+}
+
+void Profiler::count(const char* name, double value)
+{
+	if (!isProfilerThread())
+		return;
+
+	if (sFrames.empty())
+		endFrame();
+
+	ProfileCounter counter = { name, SDL_GetPerformanceCounter(), value };
+	sFrames[sCurrent].counters.push_back(counter);
+}
+
+void Profiler::endFrame()
+{
+	if (!isProfilerThread())
+		return;
+
+	Uint64 now = SDL_GetPerformanceCounter();
+
+	if (sFrames.empty())
+	{
+		sFrames.resize(PROFILE_FRAMES);
+		for (std::vector<ProfileFrame>::iterator iter = sFrames.begin(); iter != sFrames.end(); iter++)
+		{
+			iter->events.reserve(PROFILE_EVENTS_PER_FRAME);
+			iter->counters.reserve(PROFILE_COUNTERS_PER_FRAME);
+		}
+	}
+	else
+	{
+		sFrames[sCurrent].end = now;
+		sCurrent = (sCurrent + 1) % PROFILE_FRAMES;
+		//the slot being recorded is not a finished frame
+		if (sRecorded < PROFILE_FRAMES - 1)
+			sRecorded++;
+	}
+
+	sFrames[sCurrent].start = now;
+	sFrames[sCurrent].events.clear();
+	sFrames[sCurrent].counters.clear();
+}
+
+bool Profiler::writeChromeTrace(const std::string &path)
+{
+	std::ofstream file(path.c_str());
+	if (!file)
+		return false;
+
+	double usPerCount = 1000000.0 / SDL_GetPerformanceFrequency();
+	Uint64 origin = 0;
+	bool first = true;
+
+	file << "{\"traceEvents\":[\n";
+
+	//oldest finished frame first
+	for (int i = 0; i < sRecorded; i++)
+	{
+		ProfileFrame &frame = sFrames[(sCurrent - sRecorded + i + PROFILE_FRAMES) % PROFILE_FRAMES];
+		if (i == 0)
+			origin = frame.start;
+
+		file << (first ? "" : ",\n") << "{\"name\":\"Frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+			<< ",\"ts\":" << static_cast<Sint64>(frame.start - origin) * usPerCount << ",\"dur\":" << (frame.end - frame.start) * usPerCount << "}";
+		first = false;
+
+		for (std::vector<ProfileEvent>::iterator event = frame.events.begin(); event != frame.events.end(); event++)
+		{
+			file << ",\n{\"name\":\"" << event->name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+				<< ",\"ts\":" << static_cast<Sint64>(event->start - origin) * usPerCount << ",\"dur\":" << (event->end - event->start) * usPerCount
+				<< ",\"args\":{\"depth\":" << event->depth << "}}";
+		}
+
+		for (std::vector<ProfileCounter>::iterator counter = frame.counters.begin(); counter != frame.counters.end(); counter++)
+		{
+			file << ",\n{\"name\":\"" << counter->name << "\",\"ph\":\"C\",\"pid\":1,\"tid\":1"
+				<< ",\"ts\":" << static_cast<Sint64>(counter->time - origin) * usPerCount
+				<< ",\"args\":{\"value\":" << counter->value << "}}";
+		}
+	}
+
+	file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return file.good();
+}
+
+#endif
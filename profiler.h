@@ -0,0 +1,135 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+//Frame profiler.
+//PROFILE_ZONE("name") times the rest of the enclosing scope, and PROFILE_FRAME() ends a frame.
+//PROFILE_COUNTER("name", value) records a value, such as a number of Actors drawn, which the trace shows as a graph.
+//The zones of the last PROFILE_FRAMES frames are kept in a ring buffer and can be exported with PROFILE_EXPORT("file.json")
+//to the Chrome trace_event format, which chrome://tracing and Perfetto can open.
+//
+//The profiler is compiled in for debug builds, or when MAPEXPLORER_PROFILE is defined.
+//Otherwise every macro expands to nothing and the profiler costs nothing.
+//Zones are only recorded on the thread set with PROFILE_MAIN_THREAD(), which has to be called before any other thread starts;
+//zones on other threads, such as the level loader's worker, are ignored.
+
+#if defined(_DEBUG) && !defined(MAPEXPLORER_NO_PROFILE) && !defined(MAPEXPLORER_PROFILE)
+#define MAPEXPLORER_PROFILE
+#endif
+
+#ifdef MAPEXPLORER_PROFILE
+
+#include <string>
+#include <vector>
+#include <thread>
+
+#if defined(_MSC_VER)
+#include <SDL.h>
+#elif defined(__clang__)
+#include <SDL2/SDL.h>
+#else
+#include <SDL2/SDL.h>
+#endif
+
+//Number of frames in the ring buffer. The last PROFILE_FRAMES - 1 finished frames are exported.
+const int PROFILE_FRAMES = 300;
+
+//One timed zone. Names are string literals, so they are stored by pointer.
+struct ProfileEvent
+{
+	const char* name;
+	Uint64 start, end;			//performance counter values
+	int depth;					//number of zones the zone is nested in
+};
+
+//One counter value.
+struct ProfileCounter
+{
+	const char* name;
+	Uint64 time;				//performance counter value
+	double value;
+};
+
+//The zones and counters recorded during one frame.
+struct ProfileFrame
+{
+	Uint64 start, end;
+	std::vector<ProfileEvent> events;
+	std::vector<ProfileCounter> counters;
+};
+
+class Profiler
+{
+public:
+	//Makes the calling thread the one zones are recorded on. Must be called before other threads are started,
+	//so that they never see the owner change.
+	static void setThread() { sThread = std::this_thread::get_id(); }
+
+	//Records a finished zone.
+	static void record(const char* name, Uint64 start, Uint64 end, int depth);
+
+	//Records a counter value.
+	static void count(const char* name, double value);
+
+	//Ends the current frame and starts the next one, overwriting the oldest frame in the ring buffer.
+	static void endFrame();
+
+	//Writes the recorded frames as Chrome trace_event JSON. Returns false if the file cannot be written.
+	static bool writeChromeTrace(const std::string &path);
+
+	//Depth of the zone being entered, incremented while it is open. Zones on other threads leave the depth alone.
+	static int enterZone();
+	static void leaveZone();
+
+private:
+	static bool isProfilerThread();
+
+	static std::vector<ProfileFrame> sFrames;
+	static int sCurrent;			//frame being recorded
+	static int sRecorded;			//number of finished frames, up to PROFILE_FRAMES - 1
+	static int sDepth;
+	static std::thread::id sThread;
+};
+
+//Times the scope it is declared in.
+class ProfileZone
+{
+public:
+	ProfileZone(const char* name)
+		:mName(name), mDepth(Profiler::enterZone()), mStart(SDL_GetPerformanceCounter())
+	{
+	}
+
+	~ProfileZone()
+	{
+		Profiler::record(mName, mStart, SDL_GetPerformanceCounter(), mDepth);
+		Profiler::leaveZone();
+	}
+
+private:
+	const char* mName;
+	int mDepth;
+	Uint64 mStart;
+
+	ProfileZone(const ProfileZone&);
+	ProfileZone& operator= (const ProfileZone&);
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_MAIN_THREAD() Profiler::setThread()
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_COUNTER(name, value) Profiler::count(name, value)
+#define PROFILE_FRAME() Profiler::endFrame()
+#define PROFILE_EXPORT(path) Profiler::writeChromeTrace(path)
+
+#else
+
+#define PROFILE_MAIN_THREAD()
+#define PROFILE_ZONE(name)
+#define PROFILE_COUNTER(name, value)
+#define PROFILE_FRAME()
+#define PROFILE_EXPORT(path)
+
+#endif
+
+#endif
@@ -0,0 +1,137 @@
+#include "spatialhash.h"
+#include "actor.h"
+
+//Number of buckets the grid cells are hashed into. Must be a power of two.
+const int NUM_BUCKETS = 4096;
+
+//Divides and rounds towards negative infinity, so that cells left of and above the level are numbered correctly.
+inline int floorDiv(int a, int b)
+{
+	int q = a / b;
+	if ((a % b != 0) && ((a < 0) != (b < 0)))
+		q--;
+	return q;
+}
+
+SpatialHash::SpatialHash()
+	:mBuckets(NUM_BUCKETS), mCellWidth(1), mCellHeight(1), mQueryStamp(0)
+{
+}
+
+void SpatialHash::reset(int cellWidth, int cellHeight)
+{
+	for (std::vector<std::vector<Actor*> >::iterator iter = mBuckets.begin(); iter != mBuckets.end(); iter++)
+		iter->clear();
+
+	mCellWidth = cellWidth > 0 ? cellWidth : 1;
+	mCellHeight = cellHeight > 0 ? cellHeight : 1;
+}
+
+SDL_Rect SpatialHash::cellRange(const SDL_Rect &box) const
+{
+	SDL_Rect cells;
+	cells.x = floorDiv(box.x, mCellWidth);
+	cells.y = floorDiv(box.y, mCellHeight);
+
+	//the right and bottom edges are exclusive, as in detectOverlap()
+	int w = box.w > 0 ? box.w : 1;
+	int h = box.h > 0 ? box.h : 1;
+	cells.w = floorDiv(box.x + w - 1, mCellWidth) - cells.x + 1;
+	cells.h = floorDiv(box.y + h - 1, mCellHeight) - cells.y + 1;
+	return cells;
+}
+
+std::vector<Actor*> &SpatialHash::bucket(int cellX, int cellY)
+{
+	unsigned hash = (static_cast<unsigned>(cellX) * 73856093u) ^ (static_cast<unsigned>(cellY) * 19349663u);
+	return mBuckets[hash & (NUM_BUCKETS - 1)];
+}
+
+void SpatialHash::addToCells(Actor* actor, const SDL_Rect &cells)
+{
+	for (int y = cells.y; y < cells.y + cells.h; y++)
+	{
+		for (int x = cells.x; x < cells.x + cells.w; x++)
+			bucket(x, y).push_back(actor);
+	}
+}
+
+void SpatialHash::removeFromCells(Actor* actor, const SDL_Rect &cells)
+{
+	for (int y = cells.y; y < cells.y + cells.h; y++)
+	{
+		for (int x = cells.x; x < cells.x + cells.w; x++)
+		{
+			//Several cells may hash to the same bucket, so only one copy is removed per cell.
+			//Order within a bucket does not matter, so the last element is swapped into the gap.
+			std::vector<Actor*> &cellBucket = bucket(x, y);
+			for (std::vector<Actor*>::iterator iter = cellBucket.begin(); iter != cellBucket.end(); iter++)
+			{
+				if (*iter == actor)
+				{
+					*iter = cellBucket.back();
+					cellBucket.pop_back();
+					break;
+				}
+			}
+		}
+	}
+}
+
+void SpatialHash::insert(Actor* actor)
+{
+	HashEntry* entry = actor->getHashEntry();
+	entry->cells = cellRange(*actor->getCollisionBox());
+	entry->inserted = true;
+	addToCells(actor, entry->cells);
+}
+
+void SpatialHash::remove(Actor* actor)
+{
+	HashEntry* entry = actor->getHashEntry();
+	if (!entry->inserted)
+		return;
+
+	removeFromCells(actor, entry->cells);
+	entry->inserted = false;
+}
+
+void SpatialHash::update(Actor* actor)
+{
+	HashEntry* entry = actor->getHashEntry();
+	if (!entry->inserted)
+		return;
+
+	SDL_Rect cells = cellRange(*actor->getCollisionBox());
+	if (cells.x == entry->cells.x && cells.y == entry->cells.y && cells.w == entry->cells.w && cells.h == entry->cells.h)
+		return;
+
+	removeFromCells(actor, entry->cells);
+	entry->cells = cells;
+	addToCells(actor, entry->cells);
+}
+
+void SpatialHash::query(const SDL_Rect &rect, std::vector<Actor*> &result)
+{
+	result.clear();
+	mQueryStamp++;
+
+	//Including the neighbouring cells, as collision correction can push the box into them.
+	SDL_Rect cells = cellRange(rect);
+	for (int y = cells.y - 1; y < cells.y + cells.h + 1; y++)
+	{
+		for (int x = cells.x - 1; x < cells.x + cells.w + 1; x++)
+		{
+			std::vector<Actor*> &cellBucket = bucket(x, y);
+			for (std::vector<Actor*>::iterator iter = cellBucket.begin(); iter != cellBucket.end(); iter++)
+			{
+				HashEntry* entry = (*iter)->getHashEntry();
+				if (entry->stamp != mQueryStamp)
+				{
+					entry->stamp = mQueryStamp;
+					result.push_back(*iter);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,79 @@
+#ifndef SPATIALHASH_H
+#define SPATIALHASH_H
+
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <SDL.h>
+#elif defined(__clang__)
+#include <SDL2/SDL.h>
+#else
+#include <SDL2/SDL.h>
+#endif
+
+class Actor;
+
+//Bookkeeping kept by each Actor for the spatial hash.
+struct HashEntry
+{
+	HashEntry()
+		:stamp(0), inserted(false)
+	{
+		cells.x = 0;
+		cells.y = 0;
+		cells.w = 0;
+		cells.h = 0;
+	}
+
+	//Range of cells the collision box was last stored in. w and h are the number of cells.
+	SDL_Rect cells;
+
+	//Id of the last query that returned this actor, used to return each actor only once per query.
+	unsigned stamp;
+
+	//Whether the actor is currently stored in the hash.
+	bool inserted;
+};
+
+//Uniform grid spatial hash of Actor collision boxes, used as the broadphase for collisions between Actors.
+//The grid cells are the size of the level's tiles, and an Actor is stored in every cell its collision box overlaps.
+//Cells are hashed into a fixed number of buckets, so memory does not grow with the size of the level.
+class SpatialHash
+{
+public:
+	SpatialHash();
+
+	//Removes all Actors and sets the cell dimensions in pixels. Called when a level is opened.
+	void reset(int cellWidth, int cellHeight);
+
+	//Adds an Actor at the cells its collision box overlaps.
+	void insert(Actor* actor);
+
+	//Removes an Actor from the hash.
+	void remove(Actor* actor);
+
+	//Moves an Actor to the cells its collision box currently overlaps.
+	//Should be called whenever the collision box moves; does nothing if the Actor stays in the same cells.
+	void update(Actor* actor);
+
+	//Finds all Actors stored in the cells overlapped by rect and its neighbouring cells.
+	//Each Actor is written to result once. The result may contain Actors that do not overlap rect,
+	//so the caller still has to do the exact overlap test.
+	void query(const SDL_Rect &rect, std::vector<Actor*> &result);
+
+private:
+	//Returns the range of cells overlapped by a rectangle in pixels.
+	SDL_Rect cellRange(const SDL_Rect &box) const;
+
+	//Returns the bucket holding the cell at (cellX, cellY).
+	std::vector<Actor*> &bucket(int cellX, int cellY);
+
+	void addToCells(Actor* actor, const SDL_Rect &cells);
+	void removeFromCells(Actor* actor, const SDL_Rect &cells);
+
+	std::vector<std::vector<Actor*> > mBuckets;
+	int mCellWidth, mCellHeight;
+	unsigned mQueryStamp;
+};
+
+#endif
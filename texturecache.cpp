@@ -0,0 +1,186 @@
+#include "texturecache.h"
+
+#include <cctype>
+#include <stdlib.h>
+
+#if defined(_MSC_VER)
+#include <SDL_image.h>
+#elif defined(__clang__)
+#include <SDL2_image/SDL_image.h>
+#else
+#include <SDL2/SDL_image.h>
+#endif
+
+#if !defined(_WIN32)
+#include <limits.h>
+#endif
+
+std::string canonicalImagePath(const std::string &file)
+{
+#if defined(_WIN32)
+	char resolved[_MAX_PATH];
+	if (_fullpath(resolved, file.c_str(), _MAX_PATH) == NULL)
+		return file;
+
+	std::string path = resolved;
+	for (size_t i = 0; i < path.size(); i++)
+	{
+		if (path[i] == '\\')
+			path[i] = '/';
+		else
+			path[i] = static_cast<char>(tolower(static_cast<unsigned char>(path[i])));
+	}
+	return path;
+#else
+	char resolved[PATH_MAX];
+	if (realpath(file.c_str(), resolved) == NULL)
+		return file;
+	return resolved;
+#endif
+}
+
+Uint64 textureBytes(SDL_Texture* texture)
+{
+	Uint32 format;
+	int w, h;
+	if (texture == NULL || SDL_QueryTexture(texture, &format, NULL, &w, &h) != 0)
+		return 0;
+
+	//YUV formats report no bytes per pixel, and take 12 bits per pixel
+	if (SDL_ISPIXELFORMAT_FOURCC(format))
+		return static_cast<Uint64>(w) * h * 3 / 2;
+	return static_cast<Uint64>(w) * h * SDL_BYTESPERPIXEL(format);
+}
+
+TextureCache::TextureCache()
+	:mRenderer(NULL), mPlaceholders(false), mHits(0), mMisses(0), mBytes(0)
+{
+}
+
+TextureCache::~TextureCache()
+{
+	clear();
+}
+
+SDL_Texture* TextureCache::acquire(const std::string &file)
+{
+	std::string path = canonicalImagePath(file);
+
+	SDL_Texture* texture = addReference(path);
+	if (texture != NULL)
+		return texture;
+
+	texture = IMG_LoadTexture(mRenderer, file.c_str());
+	if (texture == NULL && mPlaceholders)
+		texture = createPlaceholder();
+	if (texture != NULL)
+		insert(path, texture);
+	return texture;
+}
+
+SDL_Texture* TextureCache::acquire(const std::string &file, SDL_Surface* pixels)
+{
+	std::string path = canonicalImagePath(file);
+
+	SDL_Texture* texture = addReference(path);
+	if (texture == NULL)
+	{
+		texture = SDL_CreateTextureFromSurface(mRenderer, pixels);
+		if (texture != NULL)
+			insert(path, texture);
+	}
+
+	SDL_FreeSurface(pixels);
+	return texture;
+}
+
+void TextureCache::release(SDL_Texture* texture)
+{
+	if (texture == NULL)
+		return;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	std::map<SDL_Texture*, std::string>::iterator path = mPaths.find(texture);
+	if (path == mPaths.end())
+		return;
+
+	std::map<std::string, Entry>::iterator entry = mEntries.find(path->second);
+	if (--entry->second.references > 0)
+		return;
+
+	mBytes -= entry->second.bytes;
+	SDL_DestroyTexture(texture);
+	mEntries.erase(entry);
+	mPaths.erase(path);
+}
+
+bool TextureCache::contains(const std::string &file) const
+{
+	std::string path = canonicalImagePath(file);
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mEntries.find(path) != mEntries.end();
+}
+
+void TextureCache::clear()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for (std::map<std::string, Entry>::iterator iter = mEntries.begin(); iter != mEntries.end(); iter++)
+		SDL_DestroyTexture(iter->second.texture);
+
+	mEntries.clear();
+	mPaths.clear();
+	mBytes = 0;
+}
+
+int TextureCache::getSize() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return static_cast<int>(mEntries.size());
+}
+
+Uint64 TextureCache::getMemory() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mBytes;
+}
+
+SDL_Texture* TextureCache::createPlaceholder()
+{
+	SDL_Surface* surface = SDL_CreateRGBSurface(0, PLACEHOLDER_SIZE, PLACEHOLDER_SIZE, 32, 0, 0, 0, 0);
+	if (surface == NULL)
+		return NULL;
+
+	SDL_FillRect(surface, NULL, SDL_MapRGB(surface->format, 255, 0, 255));
+	SDL_Texture* texture = SDL_CreateTextureFromSurface(mRenderer, surface);
+	SDL_FreeSurface(surface);
+	return texture;
+}
+
+SDL_Texture* TextureCache::addReference(const std::string &path)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	std::map<std::string, Entry>::iterator entry = mEntries.find(path);
+	if (entry == mEntries.end())
+	{
+		mMisses++;
+		return NULL;
+	}
+
+	mHits++;
+	entry->second.references++;
+	return entry->second.texture;
+}
+
+void TextureCache::insert(const std::string &path, SDL_Texture* texture)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	Entry entry = { texture, 1, textureBytes(texture) };
+	mEntries[path] = entry;
+	mPaths[texture] = path;
+	mBytes += entry.bytes;
+}
@@ -0,0 +1,106 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include <string>
+#include <map>
+#include <mutex>
+
+#if defined(_MSC_VER)
+#include <SDL.h>
+#elif defined(__clang__)
+#include <SDL2/SDL.h>
+#else
+#include <SDL2/SDL.h>
+#endif
+
+//Width and height of the texture used in place of images that cannot be loaded, when placeholders are enabled.
+const int PLACEHOLDER_SIZE = 256;
+
+//Returns an absolute path to a file with "." and ".." resolved, so that different spellings of a path refer to the same image.
+//Paths are case insensitive on Windows and are lowercased there. Files that do not exist are returned as given.
+std::string canonicalImagePath(const std::string &file);
+
+//Returns the memory a texture takes: its width times its height times the bytes per pixel of its format.
+//Drivers may pad or compress textures, so this is an estimate. Returns 0 for NULL.
+Uint64 textureBytes(SDL_Texture* texture);
+
+//Reference counted cache of image textures, keyed by canonical path.
+//Every tileset, map and sprite sheet that uses the same image shares one texture. A texture is destroyed once
+//every user has released it, so images that the next level shares with the current one are never decoded or uploaded again.
+class TextureCache
+{
+public:
+	TextureCache();
+
+	//Destroys every texture still in the cache.
+	~TextureCache();
+
+	//Sets the renderer textures are created with. Must be called before loading any image.
+	void setRenderer(SDL_Renderer* renderer) { mRenderer = renderer; }
+
+	//Returns the texture of an image, loading it if it is not cached yet. Each call must be matched by a call to release().
+	//Returns NULL if the image cannot be loaded.
+	SDL_Texture* acquire(const std::string &file);
+
+	//Like acquire(), but uploads an image that was already decoded if it is not cached yet.
+	//The surface is freed either way.
+	SDL_Texture* acquire(const std::string &file, SDL_Surface* pixels);
+
+	//Substitutes a placeholder texture for images that cannot be loaded, instead of returning NULL.
+	//Used by the headless mode, which has to run without the game's images.
+	void setPlaceholders(bool enable) { mPlaceholders = enable; }
+
+	//Releases a texture returned by acquire(). NULL and textures that are not in the cache are ignored.
+	void release(SDL_Texture* texture);
+
+	//Returns true if an image is cached. Unlike the rest of the cache, this may be called from any thread.
+	bool contains(const std::string &file) const;
+
+	//Destroys every texture, whether or not it is still in use. Used when the renderer is destroyed.
+	void clear();
+
+	//Number of acquires that found their image in the cache, and that had to load it.
+	int getHits() const { return mHits; }
+	int getMisses() const { return mMisses; }
+
+	//Number of textures in the cache.
+	int getSize() const;
+
+	//Memory taken by the textures in the cache, in bytes, see textureBytes().
+	Uint64 getMemory() const;
+
+private:
+	struct Entry
+	{
+		SDL_Texture* texture;
+		int references;
+		Uint64 bytes;
+	};
+
+	//Adds a reference to a cached texture, or returns NULL if the image is not cached.
+	SDL_Texture* addReference(const std::string &path);
+
+	//Adds a newly loaded texture with one reference.
+	void insert(const std::string &path, SDL_Texture* texture);
+
+	//Creates a PLACEHOLDER_SIZE square texture of a single color.
+	SDL_Texture* createPlaceholder();
+
+	SDL_Renderer* mRenderer;
+	bool mPlaceholders;
+
+	std::map<std::string, Entry> mEntries;			//by canonical path
+	std::map<SDL_Texture*, std::string> mPaths;		//canonical path of each texture, for release()
+
+	//The level loader's worker thread checks which images are cached, so the maps are locked.
+	mutable std::mutex mMutex;
+
+	int mHits, mMisses;
+	Uint64 mBytes;
+
+	//Textures are owned by the cache and are not copied.
+	TextureCache(const TextureCache&);
+	TextureCache& operator= (const TextureCache&);
+};
+
+#endif
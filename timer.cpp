@@ -1,7 +1,7 @@
 #include "timer.h"
 
 Timer::Timer()
-	:mStartTicks(0), mPausedTicks(0), mStarted(false), mPaused(false)
+	:mStartCount(0), mPausedCount(0), mStarted(false), mPaused(false)
 {
 }
 
@@ -9,7 +9,7 @@ void Timer::Start()
 {
 	mStarted = true;
 	mPaused = false;
-	mStartTicks = SDL_GetTicks();
+	mStartCount = SDL_GetPerformanceCounter();
 }
 
 void Timer::Stop()
@@ -23,7 +23,7 @@ void Timer::Pause()
 	if(mStarted && !mPaused)
 	{
 		mPaused = true;
-		mPausedTicks = SDL_GetTicks() - mStartTicks;
+		mPausedCount = SDL_GetPerformanceCounter() - mStartCount;
 	}
 }
 
@@ -32,8 +32,8 @@ void Timer::Unpause()
 	if(mStarted && mPaused)
 	{
 		mPaused = false;
-		mStartTicks = SDL_GetTicks() - mPausedTicks;
-		mPausedTicks = 0;
+		mStartCount = SDL_GetPerformanceCounter() - mPausedCount;
+		mPausedCount = 0;
 	}
 }
 
@@ -44,18 +44,55 @@ int Timer::Restart()
 	return elapsedTicks;
 }
 
+double Timer::RestartMilliseconds()
+{
+	//reading the counter once, so no time is lost between measuring and restarting
+	Uint64 now = SDL_GetPerformanceCounter();
+	double elapsed = mStarted ? (mPaused ? mPausedCount : now - mStartCount) * 1000.0 / Frequency() : 0;
+
+	mStarted = true;
+	mPaused = false;
+	mStartCount = now;
+	return elapsed;
+}
+
 int Timer::Ticks() const
+{
+	return static_cast<int>(Elapsed() * 1000 / Frequency());
+}
+
+double Timer::Milliseconds() const
+{
+	return Elapsed() * 1000.0 / Frequency();
+}
+
+Uint64 Timer::Microseconds() const
+{
+	//split to avoid overflowing when multiplying large counts
+	Uint64 elapsed = Elapsed();
+	Uint64 frequency = Frequency();
+	return elapsed / frequency * 1000000 + elapsed % frequency * 1000000 / frequency;
+}
+
+bool Timer::Started() const {return mStarted;}
+
+bool Timer::Paused() const {return mPaused;}
+
+Uint64 Timer::Frequency()
+{
+	//the frequency is fixed at boot, so it is only queried once
+	static Uint64 frequency = SDL_GetPerformanceFrequency();
+	return frequency;
+}
+
+Uint64 Timer::Elapsed() const
 {
 	if(mStarted)
 	{
 		if(mPaused)
-			return mPausedTicks;
+			return mPausedCount;
 		else
-			return SDL_GetTicks() - mStartTicks;
+			return SDL_GetPerformanceCounter() - mStartCount;
 	}
 	return 0;
 }
-
-bool Timer::Started() const {return mStarted;}
-
-bool Timer::Paused() const {return mPaused;}
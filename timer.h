@@ -6,6 +6,8 @@
  
 /**
 *  What we think our timer should look like
+*  Time is measured with SDL's high resolution performance counter,
+*  so intervals well below a millisecond can be measured.
 */
 class Timer {
 public:
@@ -22,21 +24,45 @@ public:
     */
     int Restart();
 
+    /**
+    *  Restart the timer and return the elapsed time
+    *  @return The elapsed time in milliseconds, with sub-millisecond precision
+    */
+    double RestartMilliseconds();
+
     /**
     *  Get the elapsed ticks
-    *  @return The elapsed ticks
+    *  @return The elapsed ticks, in whole milliseconds
     */
     int Ticks() const;
 
+    /**
+    *  Get the elapsed time
+    *  @return The elapsed time in milliseconds, with sub-millisecond precision
+    */
+    double Milliseconds() const;
+
+    /**
+    *  Get the elapsed time
+    *  @return The elapsed time in microseconds
+    */
+    Uint64 Microseconds() const;
+
     ///Check if Timer is started
     bool Started() const;
 
     ///Check if Timer is paused
     bool Paused() const;
+
+    ///Performance counter ticks per second
+    static Uint64 Frequency();
  
 private:
-    int mStartTicks, mPausedTicks;
+    ///Elapsed performance counter ticks
+    Uint64 Elapsed() const;
+
+    Uint64 mStartCount, mPausedCount;
     bool mStarted, mPaused;
 };
  
-#endif
\ No newline at end of file
+#endif
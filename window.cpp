@@ -1,6 +1,7 @@
 #include <string>
 #include <stdexcept>
 #include <memory>
+#include <algorithm>
 
 #if defined(_MSC_VER)
 #include <SDL.h>
@@ -19,9 +20,19 @@
 
 #include "window.h"
 
+//Quads a batch is expected to hold. Larger batches grow the vertex buffer once, after which queuing does not allocate.
+const int BATCH_QUADS = 4096;
+
 Window::Window()
-	:mWindow(NULL), mRenderer(NULL)
+	:mWindow(NULL), mRenderer(NULL), mTarget(NULL), mColor(NULL), mDrawCalls(0), mSpritesDrawn(0)
 {
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	mBatchTexture = NULL;
+	mBatchTextureW = 0;
+	mBatchTextureH = 0;
+	mBatchVertices.reserve(BATCH_QUADS * 4);
+	mBatchIndices.reserve(BATCH_QUADS * 6);
+#endif
 }
 
 void Window::Init(std::string title, int width, int height)
@@ -45,17 +56,67 @@ void Window::Init(std::string title, int width, int height)
         throw std::runtime_error("Failed to create window");
 
     //Create the renderer
-    mRenderer = SDL_CreateRenderer(mWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    //Render targets are used to pre-render the static tile layers
+    mRenderer = SDL_CreateRenderer(mWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_TARGETTEXTURE);
+    if (mRenderer == NULL)
+        throw std::runtime_error("Failed to create renderer");
+    mTextures.setRenderer(mRenderer);
+    mGlyphs.setRenderer(mRenderer);
+
+	mColor = LoadImage("green.png");
+}
+
+void Window::InitHeadless(int width, int height)
+{
+    //the dummy video driver needs no display
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0)
+		throw std::runtime_error("SDL Init Failed");
+    if (TTF_Init() == -1)
+		throw std::runtime_error("TTF Init Failed");
+
+    mBox.x = 0;
+    mBox.y = 0;
+    mBox.w = width;
+    mBox.h = height;
+
+    //There is no window, everything is drawn to a surface by the software renderer
+    mTarget = SDL_CreateRGBSurface(0, mBox.w, mBox.h, 32, 0, 0, 0, 0);
+    if (mTarget == NULL)
+        throw std::runtime_error("Failed to create render surface");
+
+    mRenderer = SDL_CreateSoftwareRenderer(mTarget);
     if (mRenderer == NULL)
         throw std::runtime_error("Failed to create renderer");
+    mTextures.setRenderer(mRenderer);
+    mGlyphs.setRenderer(mRenderer);
+    mTextures.setPlaceholders(true);
 
 	mColor = LoadImage("green.png");
 }
 
 void Window::Quit()
 {
-	SDL_DestroyRenderer(mRenderer);
-	SDL_DestroyWindow(mWindow);
+	//queued quads refer to textures that are about to be destroyed
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	mBatchTexture = NULL;
+	mBatchVertices.clear();
+	mBatchIndices.clear();
+#endif
+
+	//textures belong to the renderer, so they are destroyed first, and fonts are closed before TTF_Quit
+	mTextures.clear();
+	mGlyphs.clear();
+	mColor = NULL;
+	if (mRenderer != NULL)
+		SDL_DestroyRenderer(mRenderer);
+	if (mWindow != NULL)
+		SDL_DestroyWindow(mWindow);
+	if (mTarget != NULL)
+		SDL_FreeSurface(mTarget);
+	mRenderer = NULL;
+	mWindow = NULL;
+	mTarget = NULL;
     TTF_Quit();
     SDL_Quit();
 }
@@ -67,6 +128,9 @@ Window::~Window()
 void Window::Draw(SDL_Texture *tex, SDL_Rect &dstRect, SDL_Rect *clip, float angle, 
                   int xPivot, int yPivot, SDL_RendererFlip flip)
 {
+    //queued quads are drawn first, so that they stay under this texture
+    FlushBatch();
+
     //Convert pivot pos from relative to object's top-left corner to be relative to its center
     xPivot += dstRect.w / 2;
     yPivot += dstRect.h / 2;
@@ -74,6 +138,8 @@ void Window::Draw(SDL_Texture *tex, SDL_Rect &dstRect, SDL_Rect *clip, float ang
     SDL_Point pivot = { xPivot, yPivot };
     //Draw the texture
     SDL_RenderCopyEx(mRenderer, tex, clip, &dstRect, angle, &pivot, flip);
+    mDrawCalls++;
+    mSpritesDrawn++;
 }
 
 void Window::Draw(SDL_Texture *tex, int x, int y, SDL_Rect *clip, float angle, 
@@ -105,20 +171,200 @@ void Window::Draw(SDL_Texture *tex, int x, int y, SDL_Rect *clip, float angle,
 	dstRect.h *= SIZE_FACTOR;
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+    FlushBatch();
     SDL_RenderCopyEx(mRenderer, tex, clip, &dstRect, angle, &pivot, flip);
+    mDrawCalls++;
+    mSpritesDrawn++;
+}
+
+void Window::DrawBatched(SDL_Texture *tex, int x, int y, const SDL_Rect *clip)
+{
+	SDL_Rect src;
+	if (clip == NULL)
+	{
+		src.x = 0;
+		src.y = 0;
+		SDL_QueryTexture(tex, NULL, NULL, &src.w, &src.h);
+	}
+	else
+		src = *clip;
+
+	//the same rectangle Draw() would scale the texture to
+	SDL_Rect dst = { x * SIZE_FACTOR, y * SIZE_FACTOR, src.w * SIZE_FACTOR, src.h * SIZE_FACTOR };
+	SDL_Color white = { 255, 255, 255, 255 };
+	queueQuad(tex, src, dst, white);
+}
+
+void Window::queueQuad(SDL_Texture *tex, const SDL_Rect &src, const SDL_Rect &dst, SDL_Color color)
+{
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	if (tex != mBatchTexture)
+	{
+		FlushBatch();
+		int w, h;
+		SDL_QueryTexture(tex, NULL, NULL, &w, &h);
+		mBatchTexture = tex;
+		mBatchTextureW = static_cast<float>(w);
+		mBatchTextureH = static_cast<float>(h);
+	}
+
+	float left = static_cast<float>(dst.x);
+	float top = static_cast<float>(dst.y);
+	float right = static_cast<float>(dst.x + dst.w);
+	float bottom = static_cast<float>(dst.y + dst.h);
+
+	float u0 = src.x / mBatchTextureW;
+	float v0 = src.y / mBatchTextureH;
+	float u1 = (src.x + src.w) / mBatchTextureW;
+	float v1 = (src.y + src.h) / mBatchTextureH;
+
+	int first = static_cast<int>(mBatchVertices.size());
+	SDL_Vertex corners[4] = {
+		{ { left, top }, color, { u0, v0 } },
+		{ { right, top }, color, { u1, v0 } },
+		{ { right, bottom }, color, { u1, v1 } },
+		{ { left, bottom }, color, { u0, v1 } }
+	};
+	mBatchVertices.insert(mBatchVertices.end(), corners, corners + 4);
+
+	//two triangles per quad
+	int indices[6] = { first, first + 1, first + 2, first, first + 2, first + 3 };
+	mBatchIndices.insert(mBatchIndices.end(), indices, indices + 6);
+	mSpritesDrawn++;
+#else
+	//there is no SDL_RenderGeometry, so the texture is drawn right away, tinted with its color mod
+	SDL_SetTextureColorMod(tex, color.r, color.g, color.b);
+	SDL_SetTextureAlphaMod(tex, color.a);
+	SDL_RenderCopy(mRenderer, tex, &src, &dst);
+	SDL_SetTextureColorMod(tex, 255, 255, 255);
+	SDL_SetTextureAlphaMod(tex, 255);
+	mDrawCalls++;
+	mSpritesDrawn++;
+#endif
+}
+
+SDL_Point Window::DrawString(const std::string &message, const std::string &fontFile, int fontSize, SDL_Color color, int x, int y)
+{
+	return layoutString(message, fontFile, fontSize, &color, x, y);
+}
+
+SDL_Point Window::MeasureString(const std::string &message, const std::string &fontFile, int fontSize)
+{
+	return layoutString(message, fontFile, fontSize, NULL, 0, 0);
+}
+
+SDL_Point Window::layoutString(const std::string &message, const std::string &fontFile, int fontSize, const SDL_Color* color, int x, int y)
+{
+	TTF_Font* font = mGlyphs.getFont(fontFile, fontSize);
+	if (font == NULL)
+		throw std::runtime_error("Failed to load font: " + fontFile + TTF_GetError());
+
+	int lineSkip = TTF_FontLineSkip(font);
+	SDL_Point size = { 0, TTF_FontHeight(font) };
+	int penX = 0, penY = 0;
+	Uint16 previous = 0;
+
+	//characters are Latin-1, as with TTF_RenderText
+	for (std::string::const_iterator iter = message.begin(); iter != message.end(); iter++)
+	{
+		Uint16 character = static_cast<unsigned char>(*iter);
+		if (character == '\n')
+		{
+			penX = 0;
+			penY += lineSkip;
+			size.y = penY + TTF_FontHeight(font);
+			previous = 0;
+			continue;
+		}
+
+		const Glyph* glyph = mGlyphs.getGlyph(font, character);
+		if (glyph == NULL)
+			continue;
+
+		//older SDL_ttf does not define SDL_TTF_VERSION_ATLEAST, which cannot be used in #if then
+#ifdef SDL_TTF_VERSION_ATLEAST
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 14)
+		if (previous != 0)
+			penX += TTF_GetFontKerningSizeGlyphs(font, previous, character);
+#endif
+#endif
+
+		if (color != NULL && glyph->page != NULL)
+		{
+			SDL_Rect dst = { x + penX + glyph->offsetX, y + penY, glyph->clip.w, glyph->clip.h };
+			queueQuad(glyph->page, glyph->clip, dst, *color);
+		}
+
+		penX += glyph->advance;
+		size.x = std::max(size.x, penX);
+		previous = character;
+	}
+
+	return size;
+}
+
+void Window::FillRects(const SDL_Rect *rects, int count, SDL_Color color)
+{
+	if (count <= 0)
+		return;
+	FlushBatch();
+
+	//the draw color is also what the renderer is cleared with, so it is restored afterwards
+	Uint8 r, g, b, a;
+	SDL_BlendMode mode;
+	SDL_GetRenderDrawColor(mRenderer, &r, &g, &b, &a);
+	SDL_GetRenderDrawBlendMode(mRenderer, &mode);
+
+	SDL_SetRenderDrawColor(mRenderer, color.r, color.g, color.b, color.a);
+	SDL_SetRenderDrawBlendMode(mRenderer, SDL_BLENDMODE_BLEND);
+	SDL_RenderFillRects(mRenderer, rects, count);
+	mDrawCalls++;
+
+	SDL_SetRenderDrawBlendMode(mRenderer, mode);
+	SDL_SetRenderDrawColor(mRenderer, r, g, b, a);
+}
+
+void Window::FlushBatch()
+{
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	if (mBatchIndices.empty())
+		return;
+
+	SDL_RenderGeometry(mRenderer, mBatchTexture, &mBatchVertices[0], static_cast<int>(mBatchVertices.size()),
+		&mBatchIndices[0], static_cast<int>(mBatchIndices.size()));
+	mDrawCalls++;
+
+	//the texture is queried again for the next batch, in case it is destroyed in between
+	mBatchTexture = NULL;
+	mBatchVertices.clear();
+	mBatchIndices.clear();
+#endif
 }
 
 SDL_Texture* Window::LoadImage(const std::string &file){
-    SDL_Texture* tex = NULL;
-    tex = IMG_LoadTexture(mRenderer, file.c_str());
+    SDL_Texture* tex = mTextures.acquire(file);
     if (tex == NULL)
         throw std::runtime_error("Failed to load image: " + file + IMG_GetError());
     return tex;
 }
+SDL_Texture* Window::LoadImage(const std::string &file, SDL_Surface* pixels){
+    SDL_Texture* tex = mTextures.acquire(file, pixels);
+    if (tex == NULL)
+        throw std::runtime_error(std::string("Failed to upload image: ") + file + SDL_GetError());
+    return tex;
+}
+void Window::ReleaseImage(SDL_Texture* tex){
+    mTextures.release(tex);
+}
+SDL_Surface* Window::LoadSurface(const std::string &file){
+    SDL_Surface* surf = IMG_Load(file.c_str());
+    if (surf == NULL)
+        throw std::runtime_error("Failed to load image: " + file + IMG_GetError());
+    return surf;
+}
 SDL_Texture* Window::RenderText(const std::string &message, const std::string &fontFile, SDL_Color color, int fontSize){
-    //Open the font
-    TTF_Font *font = NULL;
-    font = TTF_OpenFont(fontFile.c_str(), fontSize);
+    //The font is kept open by the glyph cache
+    TTF_Font *font = mGlyphs.getFont(fontFile, fontSize);
     if (font == NULL)
         throw std::runtime_error("Failed to load font: " + fontFile + TTF_GetError());
 
@@ -127,7 +373,6 @@ SDL_Texture* Window::RenderText(const std::string &message, const std::string &f
     SDL_Texture *texture = SDL_CreateTextureFromSurface(mRenderer, surf);
     //Clean up unneeded stuff
     SDL_FreeSurface(surf);
-    TTF_CloseFont(font);
 
     return texture;
 }
@@ -135,10 +380,12 @@ void Window::Clear(){
     SDL_RenderClear(mRenderer);
 }
 void Window::Present(){
+    FlushBatch();
     SDL_RenderPresent(mRenderer);
 }
 SDL_Rect Window::Box(){
     //Update mBox to match the current window size
-    SDL_GetWindowSize(mWindow, &mBox.w, &mBox.h);
+    if (mWindow != NULL)
+        SDL_GetWindowSize(mWindow, &mBox.w, &mBox.h);
     return mBox;
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 
 #if defined(_MSC_VER)
 #include "SDL.h"
@@ -13,6 +14,9 @@
 #include <SDL2/SDL.h>
 #endif
 
+#include "texturecache.h"
+#include "glyphcache.h"
+
 
 //This factor is considered for any drawing functions and camera movement. It will scale up everything drawn to the screen.
 const int SIZE_FACTOR = 2;
@@ -28,6 +32,9 @@ public:
 	//Initialize SDL, setup the window and renderer
 	//@param title The window title
 	void Init(std::string title = "Window", int width = SCREEN_WIDTH, int height = SCREEN_HEIGHT);
+	//Initialize SDL without a display, rendering in software to an offscreen surface.
+	//Images that cannot be loaded are replaced by placeholders. Used to benchmark and test the game on machines without a GPU.
+	void InitHeadless(int width = SCREEN_WIDTH, int height = SCREEN_HEIGHT);
 	void Quit();
 
 	Window();
@@ -51,13 +58,47 @@ public:
                      float angle = 0.0, int xPivot = 0, int yPivot = 0,
                      SDL_RendererFlip flip = SDL_FLIP_NONE);
     /**
-    *  Loads an image directly to texture using SDL_image's
-    *  built in function IMG_LoadTexture
+    *  Queue a SDL_Texture to be drawn at (x, y), scaled by SIZE_FACTOR, without rotation or flip.
+    *  Quads queued one after the other with the same texture are drawn together with a single SDL_RenderGeometry call
+    *  when the texture changes, when Draw is called, or when the batch is flushed.
+    *  With SDL older than 2.0.18 the texture is drawn right away.
+    *  @param tex The SDL_Texture to draw
+    *  @param x The x position to draw at, before scaling
+    *  @param y The y position to draw at, before scaling
+    *  @param clip The clip to apply to the image, or NULL for the whole image
+    */
+    void DrawBatched(SDL_Texture *tex, int x, int y, const SDL_Rect *clip = NULL);
+    ///Draw the queued quads. Must be called before the render target changes and before presenting.
+    void FlushBatch();
+    /**
+    *  Loads an image to a texture through the texture cache, so that an image
+    *  used in several places is only loaded once
     *  @param file The image file to load
-    *  @return SDL_Texture* to the loaded texture
+    *  @return SDL_Texture* to the loaded texture, to be released with ReleaseImage
     */
     SDL_Texture* LoadImage(const std::string &file);
     /**
+    *  Loads an image that was already decoded with LoadSurface through the texture cache.
+    *  The surface is only uploaded if the image is not cached, and is freed either way
+    *  @param file The image file the surface was loaded from
+    *  @param pixels The decoded image
+    *  @return SDL_Texture* to the loaded texture, to be released with ReleaseImage
+    */
+    SDL_Texture* LoadImage(const std::string &file, SDL_Surface* pixels);
+    /**
+    *  Releases a texture returned by LoadImage. The texture is destroyed once
+    *  nothing else uses its image
+    *  @param tex The texture to release
+    */
+    void ReleaseImage(SDL_Texture* tex);
+    /**
+    *  Loads an image to a surface using SDL_image's IMG_Load.
+    *  This does not use the renderer, so it may be called from any thread.
+    *  @param file The image file to load
+    *  @return SDL_Surface* to the loaded image
+    */
+    static SDL_Surface* LoadSurface(const std::string &file);
+    /**
     *  Generate a texture containing the message we want to display
     *  @param message The message we want to display
     *  @param fontFile The font we want to use to render the text
@@ -66,6 +107,28 @@ public:
     *  @return An SDL_Texture* to the rendered message
     */
     SDL_Texture* RenderText(const std::string &message, const std::string &fontFile, SDL_Color color, int fontSize);
+    /**
+    *  Draw text at (x, y) in screen pixels, unscaled, through the glyph cache and the sprite batch.
+    *  Each glyph is rasterised once, so text drawn every frame creates no textures. Lines are split at '\n'
+    *  @param message The text to draw, in Latin-1
+    *  @param fontFile The font to draw the text with
+    *  @param fontSize The point size of the font
+    *  @param color The color of the text
+    *  @param x The x position of the left edge of the text
+    *  @param y The y position of the top of the first line
+    *  @return The width and height of the text in pixels
+    */
+    SDL_Point DrawString(const std::string &message, const std::string &fontFile, int fontSize, SDL_Color color, int x, int y);
+    ///Get the width and height in pixels DrawString would draw a text with
+    SDL_Point MeasureString(const std::string &message, const std::string &fontFile, int fontSize);
+    /**
+    *  Fill rectangles with a color in a single renderer call, blended by the color's alpha.
+    *  The sprite batch is flushed first, so the rectangles cover everything queued before them
+    *  @param rects The rectangles to fill, in screen pixels, unscaled
+    *  @param count The number of rectangles
+    *  @param color The color to fill the rectangles with
+    */
+    void FillRects(const SDL_Rect *rects, int count, SDL_Color color);
     ///Clear the renderer
     void Clear();
     ///Present the renderer, ie. update screen
@@ -77,12 +140,42 @@ public:
 	SDL_Renderer* getRenderer() const {return mRenderer;}
 	SDL_Rect getBox() const {return mBox;}
 	SDL_Texture* getGreen() const {return mColor;}
+	TextureCache* getTextureCache() {return &mTextures;}
+	GlyphCache* getGlyphCache() {return &mGlyphs;}
+	bool isHeadless() const {return mTarget != NULL;}
+
+	//Number of calls to the renderer since the last resetDrawCalls(): one per Draw(), and one per flushed batch.
+	int getDrawCalls() const {return mDrawCalls;}
+	//Number of textures drawn with Draw() and DrawBatched() since the last resetDrawCalls().
+	int getSpritesDrawn() const {return mSpritesDrawn;}
+	void resetDrawCalls() {mDrawCalls = 0; mSpritesDrawn = 0;}
 
 private:
+    //Queue a quad of a texture, in screen pixels and tinted with color, to the sprite batch.
+    void queueQuad(SDL_Texture *tex, const SDL_Rect &src, const SDL_Rect &dst, SDL_Color color);
+
+    //Lay out a text for DrawString and MeasureString, drawing it only if color is not NULL.
+    SDL_Point layoutString(const std::string &message, const std::string &fontFile, int fontSize, const SDL_Color* color, int x, int y);
+
     SDL_Window* mWindow;
     SDL_Renderer* mRenderer;
     SDL_Rect mBox;
+	SDL_Surface* mTarget;	//offscreen surface rendered to in headless mode
 	SDL_Texture* mColor;
+	TextureCache mTextures;
+	GlyphCache mGlyphs;
+	int mDrawCalls, mSpritesDrawn;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	//Quads queued by DrawBatched(), all with mBatchTexture.
+	SDL_Texture* mBatchTexture;
+	float mBatchTextureW, mBatchTextureH;
+	std::vector<SDL_Vertex> mBatchVertices;
+	std::vector<int> mBatchIndices;
+#endif
+
+	Window(const Window&);
+	Window& operator= (const Window&);
 };
 
 #endif
\ No newline at end of file